@@ -105,6 +105,7 @@ fast_downward_plugin(
         options/parse_tree
         options/predefinitions
         options/plugin
+        options/plugin_objects
         options/registries
         options/synergy
         options/token_parser
@@ -120,6 +121,7 @@ fast_downward_plugin(
         utils/collections
         utils/countdown_timer
         utils/hash
+        utils/json
         utils/language
         utils/logging
         utils/markup
@@ -579,8 +581,24 @@ fast_downward_plugin(
 	HELP "KStar algorithm"
     SOURCES
         kstar/kstar
+		kstar/checkpoint
+		kstar/djkstra_queue
+		kstar/explored_graph
+		kstar/graph_export
+		kstar/interleaving_policy
+		kstar/ordered_worker_pool
+		kstar/path_graph
+		kstar/path_space
+		kstar/path_space_search
+		kstar/plan_constraints
+		kstar/plan_counting
 		kstar/plan_reconstructor
+		kstar/plan_sampling
+		kstar/plan_set_writer
+		kstar/plan_sink
+		kstar/plan_statistics
 		kstar/successor_generator
+		kstar/tree_heap
 		kstar/util
     DEPENDS NULL_PRUNING_METHOD ORDERED_SET SEARCH_COMMON TOP_K_EAGER_SEARCH
 )
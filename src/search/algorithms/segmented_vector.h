@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <type_traits>
 #include <vector>
 
 /*
@@ -143,6 +144,40 @@ public:
             push_back(entry);
         }
     }
+
+    /*
+      Write all entries to out, and append count entries read from in.
+      Both copy the raw bytes of a segment at a time, so Entry has to be
+      trivially copyable and the data can only be read by the binary
+      that wrote it.
+    */
+    void write(std::ostream &out) const {
+        static_assert(std::is_trivially_copyable<Entry>::value,
+                      "entries are written as raw bytes");
+        for (size_t index = 0; index < the_size; index += SEGMENT_ELEMENTS) {
+            size_t count = std::min(SEGMENT_ELEMENTS, the_size - index);
+            out.write(reinterpret_cast<const char *>(segments[get_segment(index)]),
+                      count * sizeof(Entry));
+        }
+    }
+
+    bool read(std::istream &in, size_t count) {
+        static_assert(std::is_trivially_copyable<Entry>::value,
+                      "entries are read as raw bytes");
+        while (count > 0) {
+            size_t segment = get_segment(the_size);
+            size_t offset = get_offset(the_size);
+            if (segment == segments.size())
+                add_segment();
+            size_t num_read = std::min(SEGMENT_ELEMENTS - offset, count);
+            if (!in.read(reinterpret_cast<char *>(segments[segment] + offset),
+                         num_read * sizeof(Entry)))
+                return false;
+            the_size += num_read;
+            count -= num_read;
+        }
+        return true;
+    }
 };
 
 
@@ -263,6 +298,36 @@ public:
             push_back(entry);
         }
     }
+
+    // See SegmentedVector::write and SegmentedVector::read
+    void write(std::ostream &out) const {
+        static_assert(std::is_trivially_copyable<Element>::value,
+                      "arrays are written as raw bytes");
+        for (size_t index = 0; index < the_size; index += arrays_per_segment) {
+            size_t count = std::min(arrays_per_segment, the_size - index);
+            out.write(reinterpret_cast<const char *>(segments[get_segment(index)]),
+                      count * elements_per_array * sizeof(Element));
+        }
+    }
+
+    bool read(std::istream &in, size_t count) {
+        static_assert(std::is_trivially_copyable<Element>::value,
+                      "arrays are read as raw bytes");
+        while (count > 0) {
+            size_t segment = get_segment(the_size);
+            size_t offset = get_offset(the_size);
+            if (segment == segments.size())
+                add_segment();
+            size_t num_read = std::min(arrays_per_segment - the_size % arrays_per_segment,
+                                       count);
+            if (!in.read(reinterpret_cast<char *>(segments[segment] + offset),
+                         num_read * elements_per_array * sizeof(Element)))
+                return false;
+            the_size += num_read;
+            count -= num_read;
+        }
+        return true;
+    }
 };
 }
 
@@ -83,6 +83,8 @@ public:
     void dump_pre_post_SAS(std::ofstream& os, int pre, GlobalEffect eff) const;
 
     int get_cost() const {return cost; }
+    // Only for searches that are repaired for the new cost
+    void set_cost(int new_cost) {cost = new_cost; }
 	int get_index() const {return index; }
 };
 
@@ -463,5 +463,4 @@ void dump_pre_post_SAS(std::ostream& os, int pre, GlobalEffect eff) {
 }
 
 vector<vector<FactPair>> g_invariant_groups;
-int g_djkstra_nodes = 0;
 
@@ -41,6 +41,7 @@ CGHeuristic::~CGHeuristic() {
         delete prio_queues[i];
     for (size_t i = 0; i < transition_graphs.size(); ++i)
         delete transition_graphs[i];
+    delete cache;
 }
 
 bool CGHeuristic::dead_ends_are_reliable() const {
@@ -0,0 +1,63 @@
+#ifndef KSTAR_CHECKPOINT_H
+#define KSTAR_CHECKPOINT_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+/*
+  Checkpoints of K* (see KStar::save_checkpoint) store values and blocks
+  of the search as raw bytes in native byte order. A checkpoint can only
+  be read by the binary that wrote it, for the same task.
+*/
+namespace kstar {
+const int CHECKPOINT_MAGIC = 0x4b43504b;
+const int CHECKPOINT_VERSION = 2;
+
+template<typename T>
+void write_value(std::ostream &out, const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "values are written as raw bytes");
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<typename T>
+bool read_value(std::istream &in, T &value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "values are read as raw bytes");
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+// The number of values, then all values in one block
+template<typename T>
+void write_vector(std::ostream &out, const std::vector<T> &values) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "values are written as raw bytes");
+    int64_t size = values.size();
+    write_value(out, size);
+    out.write(reinterpret_cast<const char *>(values.data()), size * sizeof(T));
+}
+
+// T need not be default constructible, so the values are read into raw
+// storage and copied from there
+template<typename T>
+bool read_vector(std::istream &in, std::vector<T> &values) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "values are read as raw bytes");
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+    static_assert(sizeof(Storage) == sizeof(T), "values are read in one block");
+    int64_t size;
+    if (!read_value(in, size) || size < 0)
+        return false;
+    std::vector<Storage> buffer(size);
+    if (!in.read(reinterpret_cast<char *>(buffer.data()), size * sizeof(T)))
+        return false;
+    const T *begin = reinterpret_cast<const T *>(buffer.data());
+    values.assign(begin, begin + size);
+    return true;
+}
+}
+
+#endif
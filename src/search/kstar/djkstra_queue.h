@@ -0,0 +1,170 @@
+#ifndef KSTAR_DJKSTRA_QUEUE_H
+#define KSTAR_DJKSTRA_QUEUE_H
+
+#include "checkpoint.h"
+
+#include "../state_action_pair.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace kstar {
+/*
+  Queue of the path graph nodes of the Dijkstra search, ordered by g.
+  Ties are broken in favor of the node with the largest id, i.e. the
+  node added to the path graph last.
+
+  Like AdaptiveQueue, the queue starts out bucket-based and switches to a
+  heap once the number of buckets exceeds both MIN_BUCKETS_BEFORE_SWITCH
+  and the number of pushes since the last clear(). Unlike HeapQueue, the
+  heap compares the ids of nodes with equal g, so the order in which
+  nodes are popped does not depend on the representation. Nodes have to
+  be pushed in the order of their ids for the buckets to pop the largest
+  id first.
+*/
+class DjkstraQueue {
+    static const int MIN_BUCKETS_BEFORE_SWITCH = 100;
+
+    // Whether lhs is popped after rhs
+    struct PoppedLater {
+        bool operator()(const Node &lhs, const Node &rhs) const {
+            if (lhs.g != rhs.g)
+                return lhs.g > rhs.g;
+            return lhs.id < rhs.id;
+        }
+    };
+
+    std::vector<std::vector<Node>> buckets;
+    mutable int current_bucket_no;
+    std::vector<Node> heap;
+    bool use_heap;
+    size_t num_entries;
+    int num_pushes;
+
+    void update_current_bucket_no() const {
+        int num_buckets = buckets.size();
+        while (current_bucket_no < num_buckets &&
+               buckets[current_bucket_no].empty())
+            ++current_bucket_no;
+    }
+
+    void switch_to_heap() {
+        heap.reserve(num_entries);
+        for (int key = current_bucket_no; key < static_cast<int>(buckets.size()); ++key) {
+            heap.insert(heap.end(), buckets[key].begin(), buckets[key].end());
+        }
+        std::vector<std::vector<Node>>().swap(buckets);
+        current_bucket_no = 0;
+        std::make_heap(heap.begin(), heap.end(), PoppedLater());
+        use_heap = true;
+    }
+
+public:
+    DjkstraQueue()
+        : current_bucket_no(0), use_heap(false), num_entries(0),
+          num_pushes(0) {
+    }
+
+    void push(const Node &node) {
+        assert(node.g >= 0);
+        ++num_entries;
+        ++num_pushes;
+        if (!use_heap && node.g >= MIN_BUCKETS_BEFORE_SWITCH &&
+            node.g > num_pushes)
+            switch_to_heap();
+        if (use_heap) {
+            heap.push_back(node);
+            std::push_heap(heap.begin(), heap.end(), PoppedLater());
+            return;
+        }
+        int num_buckets = buckets.size();
+        if (node.g >= num_buckets)
+            buckets.resize(node.g + 1);
+        else if (node.g < current_bucket_no)
+            current_bucket_no = node.g;
+        assert(buckets[node.g].empty() || buckets[node.g].back().id < node.id);
+        buckets[node.g].push_back(node);
+    }
+
+    const Node &top() const {
+        assert(num_entries > 0);
+        if (use_heap)
+            return heap.front();
+        update_current_bucket_no();
+        return buckets[current_bucket_no].back();
+    }
+
+    void pop() {
+        assert(num_entries > 0);
+        --num_entries;
+        if (use_heap) {
+            std::pop_heap(heap.begin(), heap.end(), PoppedLater());
+            heap.pop_back();
+            return;
+        }
+        update_current_bucket_no();
+        buckets[current_bucket_no].pop_back();
+    }
+
+    bool empty() const {
+        return num_entries == 0;
+    }
+
+    size_t size() const {
+        return num_entries;
+    }
+
+    /*
+      Write the entries in bulk, either the heap as it is or the buckets
+      in the order of g, and replace the entries by the ones read back.
+      The buckets are restored as they were, so the order in which nodes
+      are popped does not change.
+    */
+    void write(std::ostream &out) const {
+        write_value(out, use_heap);
+        write_value(out, num_pushes);
+        if (use_heap) {
+            write_vector(out, heap);
+            return;
+        }
+        std::vector<Node> entries;
+        entries.reserve(num_entries);
+        for (size_t key = current_bucket_no; key < buckets.size(); ++key)
+            entries.insert(entries.end(), buckets[key].begin(), buckets[key].end());
+        write_vector(out, entries);
+    }
+
+    bool read(std::istream &in) {
+        clear();
+        std::vector<Node> entries;
+        if (!read_value(in, use_heap) || !read_value(in, num_pushes) ||
+            !read_vector(in, entries))
+            return false;
+        num_entries = entries.size();
+        if (use_heap) {
+            heap.swap(entries);
+            return true;
+        }
+        for (const Node &node : entries) {
+            if (node.g < 0)
+                return false;
+            if (node.g >= static_cast<int>(buckets.size()))
+                buckets.resize(node.g + 1);
+            buckets[node.g].push_back(node);
+        }
+        return true;
+    }
+
+    void clear() {
+        std::vector<std::vector<Node>>().swap(buckets);
+        std::vector<Node>().swap(heap);
+        current_bucket_no = 0;
+        use_heap = false;
+        num_entries = 0;
+        num_pushes = 0;
+    }
+};
+}
+
+#endif
@@ -0,0 +1,202 @@
+#include "explored_graph.h"
+
+#include <algorithm>
+#include <fstream>
+#include <queue>
+
+using namespace std;
+
+namespace explored_graph {
+static void write_int(ofstream &out, int value) {
+    int32_t data = value;
+    out.write(reinterpret_cast<const char *>(&data), sizeof(data));
+}
+
+static bool read_int(ifstream &in, int &value) {
+    int32_t data;
+    if (!in.read(reinterpret_cast<char *>(&data), sizeof(data)))
+        return false;
+    value = data;
+    return true;
+}
+
+bool ExploredGraph::write(const string &filename, string &error) const {
+    ofstream out(filename, ios_base::out | ios_base::binary);
+    if (!out) {
+        error = "could not open " + filename;
+        return false;
+    }
+    write_int(out, MAGIC);
+    write_int(out, VERSION);
+    write_int(out, flags);
+    write_int(out, operator_names.size());
+    write_int(out, get_num_states());
+    write_int(out, edges.size());
+    write_int(out, initial_state);
+    write_int(out, goal_state);
+    write_int(out, optimal_cost);
+    write_int(out, bound);
+    for (size_t op = 0; op < operator_names.size(); ++op) {
+        write_int(out, operator_costs[op]);
+        write_int(out, operator_names[op].size());
+        out.write(operator_names[op].data(), operator_names[op].size());
+    }
+    for (int state = 0; state < get_num_states(); ++state) {
+        write_int(out, cost_from_init[state]);
+        write_int(out, cost_to_goal[state]);
+    }
+    for (const Edge &edge : edges) {
+        write_int(out, edge.from);
+        write_int(out, edge.to);
+        write_int(out, edge.op);
+    }
+    out.close();
+    if (!out) {
+        error = "could not write " + filename;
+        return false;
+    }
+    return true;
+}
+
+bool ExploredGraph::read(const string &filename, string &error) {
+    ifstream in(filename, ios_base::in | ios_base::binary);
+    if (!in) {
+        error = "could not open " + filename;
+        return false;
+    }
+    int magic, version, num_operators, num_states, num_edges;
+    if (!read_int(in, magic) || magic != MAGIC) {
+        error = "not an explored graph file";
+        return false;
+    }
+    if (!read_int(in, version)) {
+        error = "truncated explored graph file";
+        return false;
+    }
+    if (version != VERSION) {
+        error = "unsupported explored graph version " + to_string(version);
+        return false;
+    }
+    error = "truncated explored graph file";
+    if (!read_int(in, flags) || !read_int(in, num_operators) ||
+        !read_int(in, num_states) || !read_int(in, num_edges) ||
+        !read_int(in, initial_state) || !read_int(in, goal_state) ||
+        !read_int(in, optimal_cost) || !read_int(in, bound))
+        return false;
+    if (num_operators < 0 || num_states < 0 || num_edges < 0 ||
+        initial_state < 0 || initial_state >= num_states ||
+        goal_state < 0 || goal_state >= num_states) {
+        error = "corrupt explored graph header";
+        return false;
+    }
+    operator_names.resize(num_operators);
+    operator_costs.resize(num_operators);
+    for (int op = 0; op < num_operators; ++op) {
+        int length;
+        if (!read_int(in, operator_costs[op]) || !read_int(in, length) || length < 0)
+            return false;
+        operator_names[op].resize(length);
+        if (!in.read(&operator_names[op][0], length))
+            return false;
+    }
+    cost_from_init.resize(num_states);
+    cost_to_goal.resize(num_states);
+    for (int state = 0; state < num_states; ++state) {
+        if (!read_int(in, cost_from_init[state]) || !read_int(in, cost_to_goal[state]))
+            return false;
+    }
+    edges.resize(num_edges);
+    for (Edge &edge : edges) {
+        if (!read_int(in, edge.from) || !read_int(in, edge.to) || !read_int(in, edge.op))
+            return false;
+        if (edge.from < 0 || edge.from >= num_states ||
+            edge.to < 0 || edge.to >= num_states ||
+            edge.op < -1 || edge.op >= num_operators ||
+            (&edge != &edges[0] && edge.from < (&edge - 1)->from)) {
+            error = "corrupt explored graph edge";
+            return false;
+        }
+    }
+    error.clear();
+    return true;
+}
+
+void enumerate_plans(
+    const ExploredGraph &graph, int max_plans, int cost_bound,
+    const function<void(const vector<int> &, int)> &consume) {
+    int num_states = graph.get_num_states();
+    vector<size_t> out_begin(num_states + 1, 0);
+    for (const ExploredGraph::Edge &edge : graph.edges)
+        ++out_begin[edge.from + 1];
+    for (int state = 0; state < num_states; ++state)
+        out_begin[state + 1] += out_begin[state];
+
+    /*
+      Walks from the initial state, given by their last edge (-1 for the
+      empty walk) and the walk before it. A generated walk only lives in
+      the queue. Once it is expanded, it is kept in walks if it has
+      successors, which refer to it, and dropped otherwise, e.g. after
+      its plan is output. So memory grows with the walks expanded, not
+      with all walks generated.
+    */
+    struct Walk {
+        int edge;
+        int parent;
+    };
+    vector<Walk> walks;
+    // A generated walk, ordered by its cost plus the cost to the goal
+    // state. Ties are broken in favor of the walk generated last, so that
+    // walks of equal f are completed depth-first. Breaking them the other
+    // way expands all prefixes of the optimal plans before outputting one.
+    struct QueueEntry {
+        int f;
+        int64_t id;
+        Walk walk;
+        int cost;
+        bool operator>(const QueueEntry &other) const {
+            if (f != other.f)
+                return f > other.f;
+            return id < other.id;
+        }
+    };
+    priority_queue<QueueEntry, vector<QueueEntry>, greater<QueueEntry>> queue;
+    int64_t num_generated = 0;
+    int initial_state = graph.initial_state;
+    if (graph.cost_to_goal[initial_state] <= cost_bound)
+        queue.push({graph.cost_to_goal[initial_state], num_generated++, {-1, -1}, 0});
+
+    int num_plans = 0;
+    vector<int> plan;
+    while (!queue.empty() && (max_plans == -1 || num_plans < max_plans)) {
+        QueueEntry entry = queue.top();
+        queue.pop();
+        int state = entry.walk.edge == -1 ?
+            initial_state : graph.edges[entry.walk.edge].to;
+        if (state == graph.goal_state) {
+            plan.clear();
+            for (Walk walk = entry.walk; walk.edge != -1; walk = walks[walk.parent]) {
+                int op = graph.edges[walk.edge].op;
+                if (op != -1)
+                    plan.push_back(op);
+            }
+            reverse(plan.begin(), plan.end());
+            consume(plan, entry.cost);
+            ++num_plans;
+        }
+        // Index of the walk in walks, once it has a successor
+        int index = -1;
+        for (size_t i = out_begin[state]; i < out_begin[state + 1]; ++i) {
+            const ExploredGraph::Edge &edge = graph.edges[i];
+            int cost = entry.cost + graph.get_cost(edge);
+            int f = cost + graph.cost_to_goal[edge.to];
+            if (f > cost_bound)
+                continue;
+            if (index == -1) {
+                walks.push_back(entry.walk);
+                index = walks.size() - 1;
+            }
+            queue.push({f, num_generated++, {static_cast<int>(i), index}, cost});
+        }
+    }
+}
+}
@@ -0,0 +1,83 @@
+#ifndef KSTAR_EXPLORED_GRAPH_H
+#define KSTAR_EXPLORED_GRAPH_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+  The graph that A* explored for a quality bound, reduced to the plans
+  within the bound (see kstar::PathSpace), as written by kstar_export
+  and read by the kstar_enumerate tool. Like the plan set reader, it
+  does not depend on the rest of the planner.
+
+  The file is a sequence of 32-bit integers in native byte order:
+
+    header          magic, version, flags, number of operators, states
+                    and edges, initial state, goal state, optimal cost,
+                    cost bound
+    operators       for each operator its cost and its name (length,
+                    then characters)
+    states          for each state the cost of the cheapest walk from
+                    the initial state and to the goal state
+    edges           source, target and operator of each edge, sorted by
+                    source
+
+  Operators do not include the artificial goal operator. The edges into
+  the goal state that stand for it have operator -1 and cost 0.
+*/
+namespace explored_graph {
+const int MAGIC = 0x4b475246;
+const int VERSION = 1;
+// A zero-cost cycle lies on the plans within the bound
+const int FLAG_ZERO_COST_CYCLE = 1;
+
+class ExploredGraph {
+public:
+    struct Edge {
+        int from;
+        int to;
+        int op;
+    };
+
+    int flags = 0;
+    int initial_state = -1;
+    int goal_state = -1;
+    int optimal_cost = -1;
+    int bound = -1;
+    std::vector<std::string> operator_names;
+    std::vector<int> operator_costs;
+    std::vector<int> cost_from_init;
+    std::vector<int> cost_to_goal;
+    std::vector<Edge> edges;
+
+    int get_num_states() const {
+        return cost_from_init.size();
+    }
+    int get_cost(const Edge &edge) const {
+        return edge.op == -1 ? 0 : operator_costs[edge.op];
+    }
+
+    // Return false and set the error message on failure
+    bool write(const std::string &filename, std::string &error) const;
+    bool read(const std::string &filename, std::string &error);
+};
+
+/*
+  Pass the plans of cost at most cost_bound, up to max_plans of them
+  (all if max_plans is -1), to consume in the order of their costs.
+  Plans are operator indices.
+
+  A best-first search over the walks from the initial state, ordered by
+  their cost plus the cost to the goal state, which is exact. So every
+  walk it expands can be completed to a plan within the bound, and the
+  time is linear in the size of the plans found times the out-degree of
+  their states, regardless of the size of the graph.
+*/
+void enumerate_plans(
+    const ExploredGraph &graph, int max_plans, int cost_bound,
+    const std::function<void(const std::vector<int> &, int)> &consume);
+}
+
+#endif
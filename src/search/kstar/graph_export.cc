@@ -0,0 +1,59 @@
+#include "graph_export.h"
+
+#include "explored_graph.h"
+#include "path_space.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+#include "../utils/system.h"
+
+using namespace std;
+
+namespace kstar {
+GraphExport::GraphExport(const options::Options &opts)
+    : PathSpaceSearch(opts),
+      graph_filename(opts.get<string>("graph_file")) {
+}
+
+void GraphExport::analyze(const PathSpace &path_space) {
+    explored_graph::ExploredGraph graph;
+    path_space.export_graph(graph);
+    graph.optimal_cost = optimal_solution_cost;
+    string error;
+    if (!graph.write(graph_filename, error)) {
+        cerr << error << endl;
+        utils::exit_with(utils::ExitCode::CRITICAL_ERROR);
+    }
+    cout << "Exported " << graph.get_num_states() << " states and "
+         << graph.edges.size() << " edges on plans of cost at most "
+         << graph.bound << " to " << graph_filename << endl;
+    if (path_space.has_infinitely_many_plans())
+        cout << "A zero-cost cycle lies on these plans" << endl;
+}
+
+static SearchEngine *_parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Graph export",
+        "Runs A* like kstar until it has explored all plans of cost at most "
+        "q times the optimal cost. Then writes the states and edges on "
+        "these plans, with their costs from the initial state and to the "
+        "goal, to a file. The kstar_enumerate tool finds the top-k and "
+        "top-q plans within this bound from the file, without the task, "
+        "so that A* runs only once for many enumerations.");
+    add_path_space_search_options(parser);
+    parser.add_option<string>("graph_file",
+        "A path to the file to write the graph to",
+        "explored_graph.bin");
+    Options opts = parser.parse();
+
+    GraphExport *engine = nullptr;
+    if (!parser.dry_run()) {
+        set_path_space_search_options(opts);
+        engine = new GraphExport(opts);
+    }
+    return engine;
+}
+
+static Plugin<SearchEngine> _plugin("kstar_export", _parse);
+}
@@ -0,0 +1,20 @@
+#ifndef KSTAR_GRAPH_EXPORT_H
+#define KSTAR_GRAPH_EXPORT_H
+
+#include "path_space_search.h"
+
+#include <string>
+
+namespace kstar {
+// Write the plans within the bound as a graph for kstar_enumerate
+class GraphExport : public PathSpaceSearch {
+    const std::string graph_filename;
+protected:
+    virtual void analyze(const PathSpace &path_space) override;
+public:
+    explicit GraphExport(const options::Options &opts);
+    virtual ~GraphExport() = default;
+};
+}
+
+#endif
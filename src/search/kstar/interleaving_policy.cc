@@ -0,0 +1,93 @@
+#include "interleaving_policy.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+#include <memory>
+
+using namespace std;
+
+namespace kstar {
+ExponentialBudgetPolicy::ExponentialBudgetPolicy(int initial_budget)
+    : initial_budget(initial_budget),
+      budget(initial_budget) {
+}
+
+bool ExponentialBudgetPolicy::switch_to_djkstra(int expansions, double) {
+    return expansions >= budget;
+}
+
+void ExponentialBudgetPolicy::notify_djkstra_run(int expansions, double) {
+    if (expansions == 0)
+        budget *= 2;
+    else
+        budget = initial_budget;
+}
+
+CostModelPolicy::CostModelPolicy(double ratio)
+    : ratio(ratio),
+      wasted_time(0) {
+}
+
+bool CostModelPolicy::switch_to_djkstra(int, double time) {
+    return time >= ratio * wasted_time;
+}
+
+void CostModelPolicy::notify_djkstra_run(int expansions, double time) {
+    wasted_time = expansions == 0 ? time : 0;
+}
+
+static shared_ptr<InterleavingPolicy> _parse_fixed_layer(OptionParser &parser) {
+    parser.document_synopsis(
+        "Fixed layer interleaving",
+        "Try the Dijkstra search of K* whenever A* reaches a new f-layer.");
+    if (parser.dry_run())
+        return nullptr;
+    return make_shared<FixedLayerPolicy>();
+}
+
+static shared_ptr<InterleavingPolicy> _parse_exponential(OptionParser &parser) {
+    parser.document_synopsis(
+        "Exponential budget interleaving",
+        "Try the Dijkstra search of K* at a new f-layer once A* expanded "
+        "a budget of states since the last try. The budget doubles after "
+        "each try that expands no path graph node.");
+    parser.add_option<int>(
+        "budget",
+        "initial number of states A* expands between Dijkstra runs",
+        "100",
+        Bounds("1", "infinity"));
+    Options opts = parser.parse();
+    if (parser.dry_run())
+        return nullptr;
+    return make_shared<ExponentialBudgetPolicy>(opts.get<int>("budget"));
+}
+
+static shared_ptr<InterleavingPolicy> _parse_cost_model(OptionParser &parser) {
+    parser.document_synopsis(
+        "Cost model interleaving",
+        "Try the Dijkstra search of K* at a new f-layer once the time A* "
+        "spent since the last try is at least ratio times the time of the "
+        "last try that expanded no path graph node.");
+    parser.add_option<double>(
+        "ratio",
+        "time in A* per time in unsuccessful Dijkstra runs",
+        "1.0",
+        Bounds("0.0", "infinity"));
+    Options opts = parser.parse();
+    if (parser.dry_run())
+        return nullptr;
+    return make_shared<CostModelPolicy>(opts.get<double>("ratio"));
+}
+
+static PluginShared<InterleavingPolicy> _plugin_fixed_layer(
+    "fixed_layer", _parse_fixed_layer);
+static PluginShared<InterleavingPolicy> _plugin_exponential(
+    "exponential_budget", _parse_exponential);
+static PluginShared<InterleavingPolicy> _plugin_cost_model(
+    "cost_model", _parse_cost_model);
+
+static PluginTypePlugin<InterleavingPolicy> _type_plugin(
+    "InterleavingPolicy",
+    "Decides when K* interrupts A* for a Dijkstra search on the path graph.");
+}
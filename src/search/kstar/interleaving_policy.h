@@ -0,0 +1,65 @@
+#ifndef KSTAR_INTERLEAVING_POLICY_H
+#define KSTAR_INTERLEAVING_POLICY_H
+
+namespace kstar {
+/*
+  Decides when K* interrupts A* for a Dijkstra search on the path graph.
+
+  A* offers a switch whenever it reaches a new f-layer after the first
+  plan was found. The Dijkstra search only expands path graph nodes once
+  A* has expanded enough states (KStar::enough_nodes_expanded), so every
+  policy finds the same plans up to tie-breaking. Policies differ in how
+  many Dijkstra runs end without expanding a single node.
+*/
+class InterleavingPolicy {
+public:
+    virtual ~InterleavingPolicy() = default;
+
+    /*
+      Return whether to switch to the Dijkstra search now. expansions and
+      time are the number of states expanded by A* and the time spent in
+      A* since the last Dijkstra run.
+    */
+    virtual bool switch_to_djkstra(int expansions, double time) = 0;
+
+    /*
+      Called after a Dijkstra run that did not find enough plans with the
+      number of path graph nodes it expanded and the time it took.
+    */
+    virtual void notify_djkstra_run(int expansions, double time) = 0;
+};
+
+// Switch at every new f-layer
+class FixedLayerPolicy : public InterleavingPolicy {
+public:
+    virtual bool switch_to_djkstra(int, double) override {
+        return true;
+    }
+    virtual void notify_djkstra_run(int, double) override {}
+};
+
+// Switch once A* expanded a budget of states. The budget doubles after
+// each Dijkstra run that expanded no node and is reset otherwise.
+class ExponentialBudgetPolicy : public InterleavingPolicy {
+    const int initial_budget;
+    int budget;
+public:
+    explicit ExponentialBudgetPolicy(int initial_budget);
+    virtual bool switch_to_djkstra(int expansions, double time) override;
+    virtual void notify_djkstra_run(int expansions, double time) override;
+};
+
+// Switch once the time spent in A* is at least ratio times the time
+// lost in the last Dijkstra run that expanded no node. This bounds the
+// share of time spent in such runs by 1 / (1 + ratio).
+class CostModelPolicy : public InterleavingPolicy {
+    const double ratio;
+    double wasted_time;
+public:
+    explicit CostModelPolicy(double ratio);
+    virtual bool switch_to_djkstra(int expansions, double time) override;
+    virtual void notify_djkstra_run(int expansions, double time) override;
+};
+}
+
+#endif
@@ -1,12 +1,18 @@
 #include "kstar.h"
 
+#include "checkpoint.h"
+#include "interleaving_policy.h"
 #include "../plugin.h"
 #include "../option_parser.h"
 #include "../search_engines/search_common.h"
 #include "../utils/util.h"
 #include "../utils/countdown_timer.h"
+#include "../utils/system.h"
 #include "util.h"
 
+#include <cstdio>
+#include <sstream>
+
 using namespace top_k_eager_search;
 
 namespace kstar{
@@ -17,37 +23,68 @@ KStar::KStar(const options::Options &opts) : TopKEagerSearch(opts),
         dump_states(opts.get<bool>("dump_states")),
         dump_json(opts.contains("json_file_to_dump")),
         json_filename(""),
+        checkpoint_interval(opts.get<double>("checkpoint_interval")),
+        resume(opts.get<bool>("resume")),
         num_node_expansions(0),
-        djkstra_initialized(false) {
+        djkstra_initialized(false),
+        djkstra_resumed(false),
+        resumed_djkstra_expansions(0),
+        successors_of(PathGraph::NO_NODE),
+        successors_epoch(-1),
+        interleaving(opts.get<shared_ptr<InterleavingPolicy>>("interleaving")),
+        expanded_at_last_djkstra_run(0),
+        last_unqualified_plan_cost(-1) {
     if (dump_json) {
         json_filename = opts.get<string>("json_file_to_dump");
     }
+    if (opts.contains("plan_set_file_to_dump")) {
+        plan_set_filename = opts.get<string>("plan_set_file_to_dump");
+    }
+    if (opts.contains("control_file")) {
+        control_filename = opts.get<string>("control_file");
+        // A later request may raise the quality bound
+        prune_by_quality_bound = false;
+    }
+    if (opts.contains("checkpoint_file")) {
+        checkpoint_filename = opts.get<string>("checkpoint_file");
+    } else if (resume) {
+        cerr << "Resuming needs a checkpoint_file" << endl;
+        utils::exit_with(utils::ExitCode::INPUT_ERROR);
+    }
     pg_succ_generator =
             unique_ptr<SuccessorGenerator>(new SuccessorGenerator(
+                                                            saps,
                                                             tree_heap,
+                                                            tree_heap_nodes,
                                                             incomming_heap,
-                                                            parent_node,
-                                                            cross_edge,
                                                             &state_registry));
     plan_reconstructor =  unique_ptr<PlanReconstructor>(new PlanReconstructor(
-                                                       parent_node,
-                                                       cross_edge,
+                                                       saps,
+                                                       path_graph,
                                                        goal_state,
                                                        &state_registry,
-                                                       &search_space, opts.get<bool>("skip_reorderings"), opts.get<bool>("dump_plans"), verbosity));
-
+                                                       &search_space, opts.get<bool>("skip_reorderings"), opts.get<bool>("dump_plans"), create_plan_sink(opts, resume), opts.get<int>("threads"), verbosity));
 }
 
 void KStar::search() {
     initialize();
+    if (resume)
+        load_checkpoint();
     utils::CountdownTimer timer(max_time);
+    checkpoint_timer.reset();
     while (status == IN_PROGRESS || status == INTERRUPTED
            || status == FIRST_PLAN_FOUND) {
-        status = step();
+        // A search resumed in a Dijkstra run goes on with that run
+        if (!djkstra_resumed)
+            status = step();
+        if (status == IN_PROGRESS && !checkpoint_filename.empty()
+            && checkpoint_timer() >= checkpoint_interval) {
+            save_checkpoint(-1);
+            checkpoint_timer.reset();
+        }
         if (timer.is_expired()) {
             cout << "Time limit reached. Aborting search." << endl;
             status = TIMEOUT;
-            plan_reconstructor->write_non_optimal_plans();
             break;
         }
         // First solution found. Add R to path graph, perform Dijkstra
@@ -61,8 +98,12 @@ void KStar::search() {
                 }                
                 status = SOLVED;
                 solution_found = true;
+                if (read_request()) {
+                    interrupt();
+                    status = INTERRUPTED;
+                    continue;
+                }
                 // Michael: need to break here
-                // Here, non-optimal plans are written at the end of the successful execution of djkstra_search()
                 break;
             }
             if (verbosity >= Verbosity::NORMAL) {
@@ -132,13 +173,21 @@ void KStar::search() {
 
             // Michael: October 9, 2020. Rewriting the part above, running Dijkstra/A* after A* was interrupted
             // First, we try Dijkstra. If enough plans found, we are done. If not, if A* queue is not empty, we continue A*.
+            if (!djkstra_resumed && !open_list->empty() && !switch_to_djkstra()) {
+                resume_astar();
+                continue;
+            }
             if (djkstra_search()) {
                 if (verbosity >= Verbosity::NORMAL) {
                     cout << "[KSTAR] Dijkstra search finished successfully, found all required plans" << endl;
                 }
                 status = SOLVED;
                 solution_found = true;
-                // Here, non-optimal plans are written at the end of the successful execution of djkstra_search()
+                if (read_request()) {
+                    interrupt();
+                    status = INTERRUPTED;
+                    continue;
+                }
                 break;
             }
             if (verbosity >= Verbosity::NORMAL) {
@@ -155,7 +204,6 @@ void KStar::search() {
                 }
                 status = FAILED;
                 solution_found = true;
-                plan_reconstructor->write_non_optimal_plans();
                 break;
             }             
         }
@@ -174,16 +222,20 @@ void KStar::search() {
 
         Plan plan;
         search_space.trace_path(g, plan);
-        plan_reconstructor->add_plan_explicit_no_check(plan);
-        set_optimal_plan_cost(plan_reconstructor->get_last_added_plan_cost());
-        inc_optimal_plans_count(plan_reconstructor->get_last_added_plan_cost());
-        statistics.inc_plans_found();
+        if (plan_constraints.uses_required_operators(plan)) {
+            plan_reconstructor->add_plan_explicit_no_check(plan);
+            set_optimal_plan_cost(plan_reconstructor->get_last_added_plan_cost());
+            inc_optimal_plans_count(plan_reconstructor->get_last_added_plan_cost());
+            statistics.inc_plans_found();
+        }
     }
 
     if (dump_json) {
         ofstream os(json_filename.c_str());
         plan_reconstructor->dump_plans_json(os, dump_states);
     }
+    if (!plan_set_filename.empty())
+        plan_reconstructor->dump_plan_set(plan_set_filename, dump_states);
 
     cout << "Actual search time: " << timer
          << " [t=" << utils::g_timer << "]" << endl;
@@ -220,11 +272,35 @@ void KStar::resume_astar() {
     interrupted = false;
 }
 
+// The successors of the top node bound the cost of the plans that the
+// Dijkstra search finds before A* has to expand more states. They are
+// generated here and used again when the node is expanded.
 void KStar::update_most_expensive_succ() {
     if(queue_djkstra.empty())
         return;
-    Node n = queue_djkstra.top();
-    most_expensive_successor = n.g + pg_succ_generator->get_max_successor_delta(n, pg_root);
+    const Node &n = queue_djkstra.top();
+    int max_delta = -1;
+    for (const Node &succ : get_djkstra_successors(n))
+        max_delta = max(max_delta, saps.get_delta(succ.sap));
+    most_expensive_successor = n.g + max_delta;
+}
+
+// Successors of node, generated at most once per Dijkstra run
+const vector<Node> &KStar::get_djkstra_successors(const Node &node) {
+    if (node.id != successors_of || successors_epoch != tree_heap_epoch) {
+        init_tree_heaps(node);
+        djkstra_successors.clear();
+        pg_succ_generator->get_successors(node, djkstra_successors);
+        successors_of = node.id;
+        successors_epoch = tree_heap_epoch;
+    }
+    return djkstra_successors;
+}
+
+void KStar::push_djkstra_successor(const Node &parent, Node &succ) {
+    succ.id = path_graph.add_node(parent.id, succ.sap, succ.cross_edge);
+    queue_djkstra.push(succ);
+    statistics.inc_total_djkstra_generations();
 }
 
 void KStar::set_optimal_plan_cost(int plan_cost) {
@@ -246,7 +322,7 @@ void KStar::initialize_djkstra() {
         g.dump_pddl();
     }
     init_tree_heap(g);
-    if (tree_heap[g].empty()) {
+    if (tree_heap[g].root == TreeHeap::NONE) {
         return;
     }
     // Generate root of path graph
@@ -254,25 +330,30 @@ void KStar::initialize_djkstra() {
         cout << "[KSTAR] Generating root of path graph" << endl;
     }
 
-    Sap sap = make_shared<StateActionPair>(StateID::no_state,
-                                           goal_state, nullptr,
-                                           &state_registry, &search_space);
+    Sap sap = saps.add(StateID::no_state, goal_state, -1, 0);
     pg_root = make_shared<Node>(0, sap, StateID::no_state);
-    pg_root->id = g_djkstra_nodes;
-    ++g_djkstra_nodes;
+    pg_root->id = path_graph.add_node(PathGraph::NO_NODE, sap, false);
     if (verbosity >= Verbosity::NORMAL) {
         cout << "[KSTAR] Adding the first plan" << endl;
     }    
-    bool added = plan_reconstructor->add_plan(*pg_root, simple_plans_only);
-    // cout << "Plan was added: " << added << endl; 
-    assert(added); // The first plan should always be successfully added
-    set_optimal_plan_cost(plan_reconstructor->get_last_added_plan_cost());
-    inc_optimal_plans_count(plan_reconstructor->get_last_added_plan_cost());
-    statistics.inc_plans_found();
+    add_cross_edge_source(*pg_root, goal_state);
+    // The cost of the plan of the root, whether it is added or not
+    set_optimal_plan_cost(search_space.get_node_info(g).real_g - 1);
+    if (uses_required_operators(pg_root->id)) {
+        // The first plan is added, unless it was found before a restart
+        bool added = plan_reconstructor->add_plan(*pg_root);
+        assert(optimal_solution_cost == plan_reconstructor->get_last_added_plan_cost());
+        if (added) {
+            inc_optimal_plans_count(plan_reconstructor->get_last_added_plan_cost());
+            statistics.inc_plans_found();
+        }
+    } else {
+        plan_reconstructor->set_root_plan_cost(optimal_solution_cost);
+        skip_unqualified_plan(*pg_root);
+    }
     Node successor;
     pg_succ_generator->get_successor_pg_root(pg_root, successor);
-    queue_djkstra.push(successor);
-    statistics.inc_total_djkstra_generations();
+    push_djkstra_successor(*pg_root, successor);
     djkstra_initialized = true;
 }
 
@@ -285,21 +366,25 @@ bool KStar::enough_plans_found_topk() const {
 }
 
 bool KStar::enough_plans_found_topq() const {
-    if (quality_bound < 1.0 || optimal_solution_cost == -1 || plan_reconstructor->number_of_plans_found() == 0)
+    if (quality_bound < 1.0 || optimal_solution_cost == -1)
         return false;
 
-    int cost = plan_reconstructor->get_last_added_plan_cost();
+    // Plans are found in the order of their costs
+    int cost = last_unqualified_plan_cost;
+    if (plan_reconstructor->number_of_plans_found() > 0)
+        cost = max(cost, plan_reconstructor->get_last_added_plan_cost());
+    if (cost == -1)
+        return false;
     double actual_bound = optimal_solution_cost * quality_bound;
     return (cost > actual_bound);
 }
 
 
-// init the neccessary tree heaps for the successor generation
-// of s that is tree_heap[s] (obviously) and from (for the cross edge)
+// init the neccessary tree heaps for the successor generation of node.
+// The heap children of node are already part of the persistent
+// tree_heap[heap_state], so only the target of the cross edge is needed.
 void KStar::init_tree_heaps(Node node) {
-    GlobalState s = state_registry.lookup_state(node.heap_state);
-    init_tree_heap(s);
-    GlobalState from  = state_registry.lookup_state(node.sap->from);
+    GlobalState from  = saps.get_from_state(node.sap);
     init_tree_heap(from);
 }
 
@@ -309,11 +394,59 @@ void KStar::throw_everything() {
         cout << "[KSTAR] Before throwing everything we had " << plan_reconstructor->number_of_plans_found() << " plans" << endl;
     }
     plan_reconstructor->clear();
+    last_unqualified_plan_cost = -1;
 
     num_node_expansions = 0;
-    statistics.reset_plans_found();
-    statistics.reset_opt_found();
-    queue_djkstra = std::priority_queue<Node>();
+    queue_djkstra.clear();
+    path_graph.clear();
+    for (StateID id : cross_edge_targets) {
+        GlobalState s = state_registry.lookup_state(id);
+        vector<Node>().swap(cross_edge_sources[s]);
+    }
+    cross_edge_targets.clear();
+    cross_edge_chains.clear();
+}
+
+void KStar::add_cross_edge_source(const Node &node, StateID state) {
+    GlobalState s = state_registry.lookup_state(state);
+    vector<Node> &sources = cross_edge_sources[s];
+    if (sources.empty())
+        cross_edge_targets.push_back(state);
+    sources.push_back(node);
+}
+
+// Connect the path graph to the edges A* found since the last Dijkstra
+// run. Path graph nodes expanded before have their cross edges into tree
+// heaps without these edges, so each of them gets an additional cross
+// edge into the generation heap of the new edges. Sources of a state are
+// expanded in order of their g-value, so the cross edges of a state are
+// generated lazily: each one is pushed when the previous one is expanded.
+void KStar::connect_new_edges() {
+    int generation = tree_heap_epoch - 1;
+    for (StateID id : cross_edge_targets) {
+        GlobalState s = state_registry.lookup_state(id);
+        int root = init_generation_heap(s, generation);
+        if (root == TreeHeap::NONE)
+            continue;
+        cross_edge_chains.push_back({id, root, cross_edge_sources[s].size()});
+        push_chain_successor(cross_edge_chains.size() - 1, 0);
+    }
+}
+
+void KStar::push_chain_successor(int chain, size_t index) {
+    const CrossEdgeChain &c = cross_edge_chains[chain];
+    if (index >= c.num_sources)
+        return;
+    GlobalState s = state_registry.lookup_state(c.state);
+    const Node &source = cross_edge_sources[s][index];
+    vector<Node> successors;
+    pg_succ_generator->add_cross_edge(source, c.state, c.heap_root,
+                                      successors);
+    for (Node &succ : successors) {
+        succ.chain = chain;
+        succ.chain_index = index;
+        push_djkstra_successor(source, succ);
+    }
 }
 
 // Djkstra search on path graph P(G) returns true if enough plans have been found
@@ -321,15 +454,30 @@ bool KStar::djkstra_search() {
     if (verbosity >= Verbosity::NORMAL) {
         std::cout << "[KSTAR] Switching to djkstra search on path graph" << std::endl;
     }
-    // When Djkstra restarts remove everything from its last iteration
-    throw_everything();
-    statistics.inc_djkstra_runs();
-    initialize_djkstra();
-    if (verbosity >= Verbosity::NORMAL) {
-        dump_dot();
-    }
+    utils::Timer djkstra_timer;
     int succ_gens = 0;
     int exps = 0;
+    if (djkstra_resumed) {
+        // The run was set up before the checkpoint was written
+        djkstra_resumed = false;
+        exps = resumed_djkstra_expansions;
+    } else {
+        // The path graph of the last run stays valid unless g-values
+        // changed. In that case, remove everything from the last run and
+        // restart.
+        if (tree_heap_reset == tree_heap_epoch) {
+            throw_everything();
+        }
+        statistics.inc_djkstra_runs();
+        ++tree_heap_epoch;
+        if (djkstra_initialized) {
+            connect_new_edges();
+        }
+        initialize_djkstra();
+        if (verbosity >= Verbosity::NORMAL) {
+            dump_dot();
+        }
+    }
     if (verbosity >= Verbosity::NORMAL) {
         cout << "[KSTAR] Start reconstructing plans using Dijkstra" << endl;
     }
@@ -339,6 +487,7 @@ bool KStar::djkstra_search() {
             if (verbosity >= Verbosity::NORMAL) {
                 cout << "[KSTAR] Not enough nodes are expanded by Astar" << endl;
             }
+            leave_djkstra(exps, djkstra_timer());
             return false;
         }
         queue_djkstra.pop();
@@ -347,7 +496,22 @@ bool KStar::djkstra_search() {
         if (verbosity >= Verbosity::NORMAL) {
             cout << "[KSTAR] Getting a plan for the node " << node.id;
         }
-        if (plan_reconstructor->add_plan(node, simple_plans_only)) {
+        // Paths in the search tree are simple, so only the sidetracks
+        // can make a plan revisit a state
+        Revisit revisit = Revisit::NONE;
+        if (simple_plans_only)
+            revisit = plan_reconstructor->find_revisit(node.id);
+        if (revisit != Revisit::NONE) {
+            if (verbosity >= Verbosity::NORMAL) {
+                cout << "  Not simple, not added" << endl;
+            }
+            statistics.inc_non_simple_plans();
+        } else if (!uses_required_operators(node.id)) {
+            if (verbosity >= Verbosity::NORMAL) {
+                cout << "  Without a required operator, not added" << endl;
+            }
+            skip_unqualified_plan(node);
+        } else if (plan_reconstructor->add_plan(node)) {
             if (verbosity >= Verbosity::NORMAL) {
                 cout << "  added with cost" << plan_reconstructor->get_last_added_plan_cost() << endl;
             }
@@ -358,22 +522,33 @@ bool KStar::djkstra_search() {
                 cout << "  Duplicate, not added" << endl;
             }
         }
+        // The node is expanded even if enough plans are found now, so
+        // that a later request can continue the search from the queue
+        exps++;
+        if (revisit == Revisit::SUBTREE) {
+            statistics.inc_pruned_djkstra_nodes();
+        } else {
+            // Usually generated already by enough_nodes_expanded
+            for (Node succ : get_djkstra_successors(node)) {
+                push_djkstra_successor(node, succ);
+                ++succ_gens;
+            }
+            add_cross_edge_source(node, saps[node.sap].from);
+        }
+        if (node.chain != -1) {
+            push_chain_successor(node.chain, node.chain_index + 1);
+        }
         if (enough_plans_found()) {
             if (verbosity >= Verbosity::NORMAL) {
                 cout << "Number of plans found: " << plan_reconstructor->number_of_plans_found() << endl;
             }
-            // Writing the non-optimal plans found
-            plan_reconstructor->write_non_optimal_plans();
+            plan_reconstructor->flush_plans();
             return true;
         }
-        exps++;
-        init_tree_heaps(node);
-        std::vector<Node> successors;
-        pg_succ_generator->get_successors(node, successors);
-        succ_gens += successors.size();
-        for (auto succ : successors) {
-            queue_djkstra.push(succ);
-            statistics.inc_total_djkstra_generations();
+        if (!checkpoint_filename.empty()
+            && checkpoint_timer() >= checkpoint_interval) {
+            save_checkpoint(exps);
+            checkpoint_timer.reset();
         }
         if (verbosity >= Verbosity::NORMAL) {
             if (succ_gens % 1000 == 0) {
@@ -384,9 +559,280 @@ bool KStar::djkstra_search() {
     if (verbosity >= Verbosity::NORMAL) {
         cout << "Number of plans found: " << plan_reconstructor->number_of_plans_found() << endl;
     }
+    leave_djkstra(exps, djkstra_timer());
     return false;
 }
 
+/*
+  Wait for the next request on the control file once enough plans are
+  found. Requests are lines of the form
+    more N: find N plans more than found so far
+    k N:    find N plans in total
+    q X:    find the plans of cost up to X times the optimal cost
+    cost C NAME: change the cost of the operator NAME to C, starting
+            with the next request of one of the forms above. C may not
+            be below the cost of the operator when the search started,
+            which the heuristics were built with.
+    quit:   stop, like the end of the file
+  The answer to each request is the line "[KSTAR] Request done" on the
+  standard output, after its plans are written to the plan sink. Plans
+  already written are not written again, so the client reads the plans
+  of each request from the end of the plan sink. After a cost change,
+  the plans found so far are dropped and the next request finds and
+  writes its plans for the new costs.
+*/
+bool KStar::read_request() {
+    if (control_filename.empty())
+        return false;
+    cout << "[KSTAR] Request done, " << plan_reconstructor->number_of_plans_found()
+         << " plans found" << endl;
+    if (!control.is_open()) {
+        control.open(control_filename);
+        if (!control) {
+            cerr << "Could not open control file " << control_filename << endl;
+            utils::exit_with(utils::ExitCode::CRITICAL_ERROR);
+        }
+    }
+    vector<pair<int, int>> new_costs;
+    string line;
+    while (getline(control, line)) {
+        istringstream request(line);
+        string command;
+        request >> command;
+        if (command.empty())
+            continue;
+        if (command == "quit")
+            return false;
+        int plans;
+        double bound;
+        if (command == "cost") {
+            int cost;
+            string name;
+            int op_index = -1;
+            if (request >> cost && cost >= 0 && getline(request, name))
+                op_index = find_operator(name);
+            if (op_index == -1 || cost_type != NORMAL) {
+                cerr << "Ignoring request " << line << endl;
+                continue;
+            }
+            int original_cost = get_original_cost(op_index);
+            if (cost < original_cost) {
+                cerr << "Ignoring request " << line << ": the heuristics "
+                     << "were built with the cost " << original_cost
+                     << " and would not be admissible" << endl;
+                continue;
+            }
+            new_costs.emplace_back(op_index, cost);
+            continue;
+        }
+        apply_cost_changes(new_costs);
+        new_costs.clear();
+        if ((command == "more" || command == "k") && request >> plans && plans > 0) {
+            number_of_plans = plans;
+            if (command == "more")
+                number_of_plans += plan_reconstructor->number_of_plans_found();
+            quality_bound = 0.0;
+        } else if (command == "q" && request >> bound && bound >= 1.0) {
+            number_of_plans = -1;
+            quality_bound = bound;
+        } else {
+            cerr << "Ignoring request " << line << endl;
+            continue;
+        }
+        if (!enough_plans_found())
+            return true;
+        cout << "[KSTAR] Request done, " << plan_reconstructor->number_of_plans_found()
+             << " plans found" << endl;
+    }
+    return false;
+}
+
+// The plans found so far have different costs after a cost change, so
+// the path graph is rebuilt and the plans are found again
+void KStar::apply_cost_changes(const vector<pair<int, int>> &new_costs) {
+    if (new_costs.empty() || !change_operator_costs(new_costs))
+        return;
+    plan_reconstructor->reset();
+    statistics.reset_plans_found();
+    statistics.reset_opt_found();
+    throw_everything();
+    optimal_solution_cost = -1;
+}
+
+/*
+  Write a snapshot of the search to the checkpoint file, between two
+  expansions of A* or of the Dijkstra search, whose expansions so far
+  are given by djkstra_expansions (-1 for A*). It holds the state of A*,
+  the edges it found and the tree heaps (see
+  TopKEagerSearch::write_checkpoint), the path graph, the Dijkstra queue
+  and the cross edges, and the plans found so far (see
+  PlanReconstructor::write_checkpoint). The snapshot is written to a
+  temporary file first, so that the checkpoint file always holds a
+  complete one.
+*/
+void KStar::save_checkpoint(int djkstra_expansions) {
+    utils::Timer checkpoint_write_timer;
+    // The position of the plan sink has to follow all accepted plans
+    plan_reconstructor->flush_plans();
+    string temp_filename = checkpoint_filename + ".tmp";
+    ofstream out(temp_filename, ios_base::out | ios_base::binary);
+    write_value(out, CHECKPOINT_MAGIC);
+    write_value(out, CHECKPOINT_VERSION);
+    write_value(out, static_cast<int>(g_operators.size()));
+    write_value(out, static_cast<int>(g_variable_domain.size()));
+    write_value(out, status);
+    write_value(out, solution_found);
+    write_value(out, djkstra_expansions);
+    write_value(out, optimal_solution_cost);
+    write_value(out, expanded_at_last_djkstra_run);
+    write_value(out, djkstra_initialized);
+    write_value(out, last_unqualified_plan_cost);
+    write_value(out, num_node_expansions);
+    write_value(out, static_cast<bool>(pg_root));
+    if (pg_root)
+        write_value(out, *pg_root);
+    write_checkpoint(out);
+
+    path_graph.write(out);
+    queue_djkstra.write(out);
+    // The targets of the cross edges, the number of sources of each and
+    // then all sources
+    write_vector(out, cross_edge_targets);
+    vector<int64_t> num_sources;
+    vector<Node> sources;
+    for (StateID id : cross_edge_targets) {
+        const vector<Node> &target_sources =
+            cross_edge_sources[state_registry.lookup_state(id)];
+        num_sources.push_back(target_sources.size());
+        sources.insert(sources.end(), target_sources.begin(), target_sources.end());
+    }
+    write_vector(out, num_sources);
+    write_vector(out, sources);
+    write_vector(out, cross_edge_chains);
+
+    plan_reconstructor->write_checkpoint(out);
+    int64_t size = out.tellp();
+    out.close();
+    if (!out || rename(temp_filename.c_str(), checkpoint_filename.c_str()) != 0) {
+        cerr << "Could not write checkpoint file " << checkpoint_filename << endl;
+        return;
+    }
+    cout << "[KSTAR] Checkpoint of " << state_registry.size() << " states, "
+         << saps.size() << " edges and " << path_graph.size()
+         << " path graph nodes written to " << checkpoint_filename
+         << " (" << size << " bytes in " << checkpoint_write_timer() << "s)" << endl;
+}
+
+// Restore the snapshot of save_checkpoint after initialize. A snapshot
+// taken during a Dijkstra run resumes that run.
+void KStar::load_checkpoint() {
+    ifstream in(checkpoint_filename, ios_base::in | ios_base::binary);
+    int magic, version, num_operators, num_variables;
+    if (!in || !read_value(in, magic) || magic != CHECKPOINT_MAGIC ||
+        !read_value(in, version) || version != CHECKPOINT_VERSION) {
+        cerr << "Could not read checkpoint file " << checkpoint_filename << endl;
+        utils::exit_with(utils::ExitCode::INPUT_ERROR);
+    }
+    bool has_root;
+    Node root;
+    vector<int64_t> num_sources;
+    vector<Node> sources;
+    auto read_cross_edges = [&]() {
+        if (!read_vector(in, cross_edge_targets) ||
+            !read_vector(in, num_sources) || !read_vector(in, sources) ||
+            num_sources.size() != cross_edge_targets.size())
+            return false;
+        size_t next_source = 0;
+        for (size_t i = 0; i < cross_edge_targets.size(); ++i) {
+            StateID id = cross_edge_targets[i];
+            if (id.get_value() < 0 ||
+                id.get_value() >= static_cast<int>(state_registry.size()) ||
+                num_sources[i] < 0 ||
+                sources.size() - next_source < static_cast<size_t>(num_sources[i]))
+                return false;
+            vector<Node> &target_sources =
+                cross_edge_sources[state_registry.lookup_state(id)];
+            target_sources.assign(sources.begin() + next_source,
+                                  sources.begin() + next_source + num_sources[i]);
+            next_source += num_sources[i];
+        }
+        return next_source == sources.size() &&
+               read_vector(in, cross_edge_chains);
+    };
+    if (!read_value(in, num_operators) || !read_value(in, num_variables) ||
+        num_operators != static_cast<int>(g_operators.size()) ||
+        num_variables != static_cast<int>(g_variable_domain.size()) ||
+        !read_value(in, status) ||
+        !read_value(in, solution_found) ||
+        !read_value(in, resumed_djkstra_expansions) ||
+        !read_value(in, optimal_solution_cost) ||
+        !read_value(in, expanded_at_last_djkstra_run) ||
+        !read_value(in, djkstra_initialized) ||
+        !read_value(in, last_unqualified_plan_cost) ||
+        !read_value(in, num_node_expansions) ||
+        !read_value(in, has_root) || (has_root && !read_value(in, root)) ||
+        !read_checkpoint(in) ||
+        !path_graph.read(in) || !queue_djkstra.read(in) ||
+        !read_cross_edges() ||
+        !plan_reconstructor->read_checkpoint(in)) {
+        cerr << "Checkpoint file " << checkpoint_filename
+             << " is truncated or does not belong to this task" << endl;
+        utils::exit_with(utils::ExitCode::INPUT_ERROR);
+    }
+    if (has_root)
+        pg_root = make_shared<Node>(root);
+    if (djkstra_initialized)
+        plan_reconstructor->set_goal_state(goal_state);
+    djkstra_resumed = resumed_djkstra_expansions >= 0;
+    cout << "[KSTAR] Resumed from " << checkpoint_filename << " with "
+         << state_registry.size() << " states, " << saps.size()
+         << " edges and " << path_graph.size() << " path graph nodes"
+         << (djkstra_resumed ? " in a Dijkstra run" : "") << endl;
+}
+
+// Ask the interleaving policy whether to interrupt A* at this f-layer
+bool KStar::switch_to_djkstra() {
+    int expansions = statistics.get_expanded() - expanded_at_last_djkstra_run;
+    bool switch_now = interleaving->switch_to_djkstra(expansions, astar_timer());
+    if (verbosity >= Verbosity::NORMAL) {
+        cout << "[KSTAR] " << (switch_now ? "Switching" : "Not switching")
+             << " to djkstra search after " << expansions
+             << " expansions in " << astar_timer() << "s" << endl;
+    }
+    if (!switch_now)
+        statistics.inc_declined_djkstra_switches();
+    return switch_now;
+}
+
+// The Dijkstra search stops without enough plans and A* resumes
+void KStar::leave_djkstra(int expansions, double time) {
+    plan_reconstructor->flush_plans();
+    interleaving->notify_djkstra_run(expansions, time);
+    if (expansions == 0)
+        statistics.inc_futile_djkstra_runs();
+    expanded_at_last_djkstra_run = statistics.get_expanded();
+    astar_timer.reset();
+}
+
+// The lazily kept plans refer to the shortest path tree
+void KStar::notify_g_change() {
+    plan_reconstructor->materialize_plans();
+    TopKEagerSearch::notify_g_change();
+}
+
+bool KStar::uses_required_operators(NodeID node) {
+    if (!plan_constraints.has_required_operators())
+        return true;
+    plan_reconstructor->collect_operators(node, checked_plan);
+    return plan_constraints.uses_required_operators(checked_plan);
+}
+
+// The plan of node does not count, but its cost does for the quality bound
+void KStar::skip_unqualified_plan(const Node &node) {
+    last_unqualified_plan_cost = optimal_solution_cost + node.g;
+    statistics.inc_unqualified_plans();
+}
+
 void KStar::inc_optimal_plans_count(int plan_cost) {
     if (plan_cost == optimal_solution_cost && plan_cost >= 0) {
         statistics.inc_opt_plans();
@@ -405,17 +851,20 @@ void KStar::dump_path_graph() {
         StateID id = *it;
         GlobalState s = state_registry.lookup_state(id);
         begin_subgraph(s.get_state_tuple(), stream);
-        for (size_t i = 0; i  < tree_heap[s].size(); ++i){
-            Sap sap = tree_heap[s][i];
-            std::string id = get_sap_id(sap, s);
-            std::string label = get_sap_label(sap);
+        vector<int> heap_nodes;
+        tree_heap_nodes.get_nodes(tree_heap[s].root, heap_nodes);
+        for (int heap_node : heap_nodes) {
+            Sap sap = tree_heap_nodes[heap_node].sap;
+            std::string id = get_sap_id(sap, s, saps);
+            std::string label = get_sap_label(sap, saps);
             Node node(0, sap, s.get_id());
+            node.heap_node = heap_node;
             vector<Node> successors;
-            pg_succ_generator->get_successors(node, successors, true);
+            pg_succ_generator->get_successors(node, successors);
             for (auto& succ : successors) {
                 GlobalState heap_state =
                         state_registry.lookup_state(succ.heap_state);
-                std::string succ_id = get_sap_id(succ.sap, heap_state);
+                std::string succ_id = get_sap_id(succ.sap, heap_state, saps);
                 add_edge(id, succ_id, std::to_string(succ.g), stream);
             }
         }
@@ -445,11 +894,11 @@ void KStar::dump_dot() const {
         stream << "\" ]\n";
 
         for (Sap sap: incomming_heap[s]) {
-            node_stream << id.hash() << "  ->  " << sap->get_from_state().get_id().hash();
-            node_stream <<" [ label=\"" << sap->op->get_name();
-            node_stream << "/"<< sap->op->get_cost();
+            node_stream << id.hash() << "  ->  " << saps[sap].from.hash();
+            node_stream <<" [ label=\"" << saps.get_op(sap)->get_name();
+            node_stream << "/"<< saps.get_op(sap)->get_cost();
             node_stream << "\"";
-            if (node_info.parent_state_id == sap->get_from_state().get_id()) {
+            if (node_info.parent_state_id == saps[sap].from) {
                 node_stream << " style=\"dashed\" color=\"#A9A9A9 \"";
             }
             node_stream << " ]\n";
@@ -495,19 +944,7 @@ void add_simple_plans_only_option(OptionParser &parser) {
     parser.add_option<bool>("simple_plans_only", "", "false");
 }
 
-
-static SearchEngine *_parse(OptionParser &parser) {
-    parser.add_option<ScalarEvaluator *>("eval", "evaluator for h-value");
-
-    top_k_eager_search::add_top_k_option(parser);
-
-    parser.add_option<bool>("dump_plans", "Print plans", "false");
-    parser.add_option<bool>("dump_states", "Dump states to json", "false");
-    
-    parser.add_option<string>("json_file_to_dump",
-        "A path to the json file to use for dumping",
-        OptionParser::NONE);
-
+void add_verbosity_option(OptionParser &parser) {
     vector<string> verbosity_levels;
     vector<string> verbosity_level_docs;
     verbosity_levels.push_back("silent");
@@ -528,9 +965,73 @@ static SearchEngine *_parse(OptionParser &parser) {
         "Option to specify the level of verbosity.",
         "silent",
         verbosity_level_docs);
+}
+
+
+static SearchEngine *_parse(OptionParser &parser) {
+    parser.add_option<ScalarEvaluator *>("eval", "evaluator for h-value");
+
+    top_k_eager_search::add_top_k_option(parser);
+
+    parser.add_option<bool>("dump_plans", "Print plans", "false");
+    add_plan_sink_options(parser);
+    parser.add_option<bool>("dump_states", "Dump states to json", "false");
+    parser.add_option<int>(
+        "threads",
+        "Number of threads that reconstruct and render the plans. While the "
+        "Dijkstra search goes on, the other threads reconstruct the plans it "
+        "accepts, which are written in order as they are done. Plans are "
+        "reconstructed on one thread if they are printed (dump_plans) or "
+        "checked (verbosity normal or verbose). Each thread adds its stack "
+        "and allocator arena to the reported peak memory.",
+        "1",
+        Bounds("1", "infinity"));
+    
+    parser.add_option<string>("json_file_to_dump",
+        "A path to the json file to use for dumping",
+        OptionParser::NONE);
+    parser.add_option<string>("plan_set_file_to_dump",
+        "A path to a binary plan set file to dump the plans (and states, "
+        "with dump_states) to. plan_set_to_json converts it to the json "
+        "format of json_file_to_dump",
+        OptionParser::NONE);
+    parser.add_option<string>("control_file",
+        "A path to a file, usually a FIFO, with further requests (more N, "
+        "k N, q X, cost C NAME, quit; one per line). Once enough plans are "
+        "found, K* reads the next request and continues the search for it "
+        "instead of starting over. The quality bound does not prune A* "
+        "then. A cost change repairs the g-values over the explored edges "
+        "and evaluates the open states again. Heuristics that precompute "
+        "from the operator costs (e.g. blind) keep the original costs, so "
+        "requests that set a cost below its original cost are rejected.",
+        OptionParser::NONE);
+    parser.add_option<string>("checkpoint_file",
+        "A path to a file that a snapshot of the search (states, search "
+        "nodes, explored edges, the path graph and the Dijkstra queue, and "
+        "the plans found) is written to periodically, also during a "
+        "Dijkstra search. With resume, the search continues from it where "
+        "it stopped. The open states are evaluated again then, and the "
+        "interleaving policy starts afresh.",
+        OptionParser::NONE);
+    parser.add_option<double>("checkpoint_interval",
+        "Seconds between two snapshots written to checkpoint_file",
+        "1800",
+        Bounds("0", "infinity"));
+    parser.add_option<bool>("resume",
+        "Resume the search from checkpoint_file. The task, the options "
+        "and the binary have to be those of the run that wrote it.",
+        "false");
+
+    add_verbosity_option(parser);
+
+    parser.add_option<shared_ptr<InterleavingPolicy>>(
+        "interleaving",
+        "when to interrupt A* for a Dijkstra search on the path graph",
+        "fixed_layer()");
 
     top_k_eager_search::add_pruning_option(parser);
     add_simple_plans_only_option(parser);
+    add_plan_constraint_options(parser);
     SearchEngine::add_options_to_parser(parser);
     Options opts = parser.parse();
     KStar *engine = nullptr;
@@ -1,17 +1,29 @@
 #ifndef KSTAR_KSTAR_H
 #define KSTAR_KSTAR_H
 
+#include "djkstra_queue.h"
 #include "successor_generator.h"
 #include "plan_reconstructor.h"
 #include "kstar_types.h"
 
 #include "../search_engines/top_k_eager_search.h"
+#include "../utils/timer.h"
 
+#include <fstream>
 #include <memory>
 
 namespace kstar {
+class InterleavingPolicy;
 
 class KStar : public top_k_eager_search::TopKEagerSearch {
+    // Cross edges from the first num_sources sources of state into a
+    // generation heap of state
+    struct CrossEdgeChain {
+        StateID state;
+        int heap_root;
+        size_t num_sources;
+    };
+
     void inc_optimal_plans_count(int plan_cost);
 protected:
     int optimal_solution_cost;
@@ -19,26 +31,68 @@ protected:
     bool dump_states;
     bool dump_json;
     std::string json_filename;
+    std::string plan_set_filename;
+    // File (usually a FIFO) to read further requests from once enough
+    // plans are found, see read_request
+    std::string control_filename;
+    std::ifstream control;
+    // File that a snapshot of the search is written to every
+    // checkpoint_interval seconds, and whether to resume from it
+    std::string checkpoint_filename;
+    double checkpoint_interval;
+    bool resume;
+    utils::Timer checkpoint_timer;
 
     int num_node_expansions;
     bool djkstra_initialized;
-    std::priority_queue<Node> queue_djkstra;
-    std::unordered_map<Node, Node> parent_node;
-    std::unordered_set<Edge> cross_edge;
+    // Whether the search resumes in the Dijkstra run of a checkpoint, and
+    // the path graph nodes that run expanded before it was written
+    bool djkstra_resumed;
+    int resumed_djkstra_expansions;
+    // Path graph nodes by g. Nodes are pushed in the order of their ids,
+    // so ties are broken deterministically in favor of the largest id.
+    DjkstraQueue queue_djkstra;
+    PathGraph path_graph;
+    // Expanded path graph nodes with a cross edge into the tree heaps of
+    // a state, in the order of their expansion
+    PerStateInformation<vector<Node>> cross_edge_sources;
+    std::vector<StateID> cross_edge_targets;
+    std::vector<CrossEdgeChain> cross_edge_chains;
     std::unique_ptr<PlanReconstructor> plan_reconstructor;
     std::shared_ptr<SuccessorGenerator> pg_succ_generator;
+    // Successors of the path graph node successors_of, generated in the
+    // Dijkstra run successors_epoch
+    std::vector<Node> djkstra_successors;
+    NodeID successors_of;
+    int successors_epoch;
+    std::shared_ptr<InterleavingPolicy> interleaving;
+    // Number of states expanded by A* up to the last Dijkstra run and
+    // the time spent in A* since then
+    int expanded_at_last_djkstra_run;
+    utils::Timer astar_timer;
+    // Cost of the last plan skipped for missing a required operator
+    int last_unqualified_plan_cost;
+    Plan checked_plan;
     // root of the path graph
     shared_ptr<Node> pg_root;
     void initialize_djkstra();
     // djkstra search return true if k solutions have been found and false otherwise
     bool djkstra_search();
+    bool switch_to_djkstra();
+    void leave_djkstra(int expansions, double time);
+    virtual void notify_g_change() override;
     bool enough_nodes_expanded();
     void resume_astar();
     void init_tree_heaps(Node node);
-    vector<Sap> djkstra_traceback(Node& top_pair);
-    vector<Sap> compute_sidetrack_seq(Node& top_pair, vector<Sap>& path);
+    const std::vector<Node> &get_djkstra_successors(const Node &node);
+    void push_djkstra_successor(const Node &parent, Node &succ);
     void throw_everything();
+    void add_cross_edge_source(const Node &node, StateID state);
+    void connect_new_edges();
+    void push_chain_successor(int chain, size_t index);
     void add_plan(Node& p);
+    bool uses_required_operators(NodeID node);
+    void skip_unqualified_plan(const Node &node);
     bool enough_plans_found() const;
     bool enough_plans_found_topk() const;
     bool enough_plans_found_topq() const;
@@ -47,11 +101,18 @@ protected:
     void dump_tree_edge();
     void dump_path_graph();
     void dump_dot() const;
+    bool read_request();
+    void apply_cost_changes(const std::vector<std::pair<int, int>> &new_costs);
+    void save_checkpoint(int djkstra_expansions);
+    void load_checkpoint();
     virtual ~KStar() = default;
 public:
     KStar (const options::Options &opts);
     void search() override;
 };
+
+void add_simple_plans_only_option(OptionParser &parser);
+void add_verbosity_option(OptionParser &parser);
 }
 
 #endif 
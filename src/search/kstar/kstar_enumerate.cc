@@ -0,0 +1,83 @@
+#include "explored_graph.h"
+
+#include "../utils/json.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+static void usage(const char *program) {
+    cerr << "usage: " << program << " <graph file> [k=N] [q=X]" << endl;
+}
+
+/*
+  Enumerate the top-k or top-q plans from a graph written by the
+  kstar_export search engine, as one JSON object per line in the format
+  of the ndjson plan sink. Without k and q, all plans within the bound of
+  the export are enumerated. q may not exceed the quality bound of the
+  export, since the graph holds no other plans.
+*/
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+    int max_plans = -1;
+    double quality_bound = -1;
+    for (int i = 2; i < argc; ++i) {
+        char *end;
+        if (strncmp(argv[i], "k=", 2) == 0) {
+            max_plans = strtol(argv[i] + 2, &end, 10);
+            if (*end || max_plans < 1) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (strncmp(argv[i], "q=", 2) == 0) {
+            quality_bound = strtod(argv[i] + 2, &end);
+            if (*end || quality_bound < 1.0) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    explored_graph::ExploredGraph graph;
+    string error;
+    if (!graph.read(argv[1], error)) {
+        cerr << argv[1] << ": " << error << endl;
+        return 1;
+    }
+    int cost_bound = graph.bound;
+    if (quality_bound != -1) {
+        cost_bound = (int) ((graph.optimal_cost * quality_bound) + 0.00001);
+        if (cost_bound > graph.bound) {
+            cerr << "The graph only holds the plans of cost at most "
+                 << graph.bound << endl;
+            return 2;
+        }
+    }
+    if (max_plans == -1 && (graph.flags & explored_graph::FLAG_ZERO_COST_CYCLE)) {
+        cerr << "Infinitely many plans, a zero-cost cycle lies on them. "
+             << "Give the number of plans with k." << endl;
+        return 2;
+    }
+
+    explored_graph::enumerate_plans(
+        graph, max_plans, cost_bound,
+        [&graph](const vector<int> &plan, int cost) {
+            cout << "{\"cost\": " << cost << ", \"actions\": [";
+            for (size_t i = 0; i < plan.size(); ++i) {
+                if (i > 0)
+                    cout << ", ";
+                utils::write_json_string(cout, graph.operator_names[plan[i]]);
+            }
+            cout << "]}\n";
+        });
+    return 0;
+}
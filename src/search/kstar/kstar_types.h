@@ -8,8 +8,10 @@
 using namespace std;
 
 namespace kstar {
-    typedef shared_ptr<StateActionPair> Sap;
-    typedef std::pair<Node, Node> Edge;
+    // Index of a StateActionPair in the SapArena
+    typedef int Sap;
+    // Id of a path graph node (see PathGraph)
+    typedef int64_t NodeID;
     typedef std::vector<const GlobalOperator*> Plan;
     typedef std::vector<StateID> StateSequence;
     typedef std::stringstream Stream;
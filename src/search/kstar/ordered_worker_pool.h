@@ -0,0 +1,155 @@
+#ifndef KSTAR_ORDERED_WORKER_POOL_H
+#define KSTAR_ORDERED_WORKER_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace kstar {
+/*
+  Produces the items pushed to the pool on worker threads and consumes
+  them in the order of the pushes on the pushing thread. Workers stay at
+  most window items ahead of the consumer, so only window items are alive
+  at any time.
+
+  push returns as soon as the item is queued, after consuming the items
+  that are ready, so the pushing thread keeps working while the workers
+  produce. It only waits if window items are pending. flush consumes all
+  pending items. Workers are started by the first push and wait idle for
+  more items until the pool is destroyed.
+
+  produce is called concurrently and must only read shared data, which
+  the pushing thread must not change until the next flush. consume is
+  only called from the pushing thread. Without workers, both are called
+  by push.
+*/
+template<typename Item>
+class OrderedWorkerPool {
+    const int num_workers;
+    const size_t window;
+    const std::function<void(Item &)> produce;
+    const std::function<void(Item &)> consume;
+
+    std::mutex mutex;
+    std::condition_variable item_pushed;
+    std::condition_variable item_ready;
+    std::vector<Item> slots;
+    std::vector<bool> ready;
+    // Items pushed, claimed by a worker and consumed so far
+    size_t pushed;
+    size_t claimed;
+    size_t consumed;
+    // Threads waiting for a condition variable, which only need to be
+    // notified then
+    int idle_workers;
+    bool consumer_waiting;
+    bool stopping;
+    std::vector<std::thread> workers;
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            ++idle_workers;
+            item_pushed.wait(lock, [this]() {
+                return stopping || claimed < pushed;
+            });
+            --idle_workers;
+            if (claimed == pushed)
+                return;
+            size_t item = claimed++;
+            lock.unlock();
+            produce(slots[item % window]);
+            lock.lock();
+            ready[item % window] = true;
+            if (consumer_waiting)
+                item_ready.notify_one();
+        }
+    }
+
+    // Consume the next item, waiting for it if wait is set. Returns
+    // whether an item was consumed.
+    bool consume_next(bool wait) {
+        size_t slot = consumed % window;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (consumed == pushed)
+                return false;
+            if (wait) {
+                consumer_waiting = true;
+                item_ready.wait(lock, [this, slot]() {return ready[slot]; });
+                consumer_waiting = false;
+            } else if (!ready[slot])
+                return false;
+        }
+        consume(slots[slot]);
+        std::lock_guard<std::mutex> lock(mutex);
+        ready[slot] = false;
+        ++consumed;
+        return true;
+    }
+
+public:
+    OrderedWorkerPool(int num_workers, size_t window,
+                      const std::function<void(Item &)> &produce,
+                      const std::function<void(Item &)> &consume)
+        : num_workers(num_workers),
+          window(window),
+          produce(produce),
+          consume(consume),
+          pushed(0),
+          claimed(0),
+          consumed(0),
+          idle_workers(0),
+          consumer_waiting(false),
+          stopping(false) {
+    }
+
+    ~OrderedWorkerPool() {
+        flush();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        item_pushed.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    void push(Item item) {
+        if (num_workers == 0) {
+            produce(item);
+            consume(item);
+            return;
+        }
+        if (workers.empty()) {
+            slots.resize(window);
+            ready.assign(window, false);
+            for (int i = 0; i < num_workers; ++i)
+                workers.emplace_back(&OrderedWorkerPool::work, this);
+        }
+        while (pushed == consumed + window)
+            consume_next(true);
+        slots[pushed % window] = std::move(item);
+        bool notify;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++pushed;
+            notify = idle_workers > 0;
+        }
+        if (notify)
+            item_pushed.notify_one();
+        while (consume_next(false)) {
+        }
+    }
+
+    void flush() {
+        while (consume_next(true)) {
+        }
+    }
+};
+}
+
+#endif
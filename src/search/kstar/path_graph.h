@@ -0,0 +1,68 @@
+#ifndef KSTAR_PATH_GRAPH_H
+#define KSTAR_PATH_GRAPH_H
+
+#include "checkpoint.h"
+#include "kstar_types.h"
+
+#include "../algorithms/segmented_vector.h"
+
+#include <cstdint>
+
+namespace kstar {
+/*
+  The part of the path graph P(G) generated by the Dijkstra search,
+  stored as a tree of parent pointers indexed by node id. For each node
+  we keep its edge and whether the node was reached from its parent via
+  a cross edge. This is all that is needed to compute the sidetrack
+  sequence of a node.
+*/
+struct PathGraphEntry {
+    NodeID parent = -1;
+    Sap sap = -1;
+    bool cross_edge = false;
+};
+
+class PathGraph {
+    segmented_vector::SegmentedVector<PathGraphEntry> entries;
+public:
+    static const NodeID NO_NODE = -1;
+
+    // Add a node reached from parent and return its id
+    NodeID add_node(NodeID parent, Sap sap, bool cross_edge) {
+        PathGraphEntry entry;
+        entry.parent = parent;
+        entry.sap = sap;
+        entry.cross_edge = cross_edge;
+        entries.push_back(entry);
+        return entries.size() - 1;
+    }
+
+    const PathGraphEntry &operator[](NodeID id) const {
+        return entries[id];
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+
+    void clear() {
+        entries.resize(0);
+    }
+
+    // Write all nodes in bulk, and replace them by the nodes read back
+    void write(std::ostream &out) const {
+        int64_t num_entries = entries.size();
+        write_value(out, num_entries);
+        entries.write(out);
+    }
+
+    bool read(std::istream &in) {
+        int64_t num_entries;
+        clear();
+        return read_value(in, num_entries) && num_entries >= 0 &&
+               entries.read(in, num_entries);
+    }
+};
+}
+
+#endif
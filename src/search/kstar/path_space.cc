@@ -0,0 +1,434 @@
+#include "path_space.h"
+
+#include "explored_graph.h"
+
+#include "../globals.h"
+#include "../search_space.h"
+#include "../state_registry.h"
+
+#include "../algorithms/priority_queues.h"
+#include "../utils/rng.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+namespace kstar {
+const PathSpace::Count PathSpace::MAX_COUNT;
+
+static bool is_goal_operator(int op_index) {
+    return op_index == static_cast<int>(g_operators.size()) - 1;
+}
+
+// The artificial goal operator does not count for the cost of a plan
+static int get_plan_cost(int op_index) {
+    if (is_goal_operator(op_index))
+        return 0;
+    return g_operators[op_index].get_cost();
+}
+
+PathSpace::PathSpace(StateRegistry &state_registry,
+                     const SearchSpace &search_space,
+                     const SapArena &saps,
+                     const PerStateInformation<vector<Sap>> &incoming_heap,
+                     StateID goal_state,
+                     int bound)
+    : bound(bound),
+      num_states(state_registry.size()),
+      initial_state(state_registry.get_initial_state().get_id().get_value()),
+      goal_state(goal_state.get_value()),
+      zero_cost_cycle(false),
+      cycle(false),
+      num_counts(0) {
+    EdgeList edges;
+    collect_edges(state_registry, search_space, saps, incoming_heap, edges);
+    build_adjacency(edges, true, in_begin, in_edges);
+    build_adjacency(edges, false, out_begin, out_edges);
+    compute_costs(out_begin, out_edges, initial_state, cost_from_init);
+    compute_costs(in_begin, in_edges, this->goal_state, cost_to_goal);
+
+    // Keep the edges on plans within the bound
+    size_t num_kept = 0;
+    for (const pair<int, Edge> &edge : edges) {
+        int from = edge.first;
+        int to = edge.second.state;
+        if (is_on_plan(from) && is_on_plan(to) &&
+            cost_from_init[from] + edge.second.cost + cost_to_goal[to] <= bound)
+            edges[num_kept++] = edge;
+    }
+    edges.resize(num_kept);
+    build_adjacency(edges, true, in_begin, in_edges);
+    build_adjacency(edges, false, out_begin, out_edges);
+
+    vector<int> sorted;
+    cycle = !topological_order(false, sorted);
+    zero_cost_cycle = !topological_order(true, order);
+    counts_begin.assign(num_states, 0);
+    num_counts = 0;
+    for (int state : order) {
+        counts_begin[state] = num_counts;
+        num_counts += get_window_size(state);
+    }
+    if (!zero_cost_cycle)
+        compute_counts(true, forward_counts);
+}
+
+/*
+  The edges of the incoming heaps, and the tree edge of each state,
+  unless it is still in the incoming heap. The search removes it from
+  the heap only once the state is expanded.
+*/
+void PathSpace::collect_edges(const StateRegistry &state_registry,
+                              const SearchSpace &search_space,
+                              const SapArena &saps,
+                              const PerStateInformation<vector<Sap>> &incoming_heap,
+                              EdgeList &edges) const {
+    const PerStateInformation<SearchNodeInfo> &search_node_infos =
+        search_space.search_node_infos;
+    for (PerStateInformation<SearchNodeInfo>::const_iterator it =
+             search_node_infos.begin(&state_registry);
+         it != search_node_infos.end(&state_registry); ++it) {
+        GlobalState state = state_registry.lookup_state(*it);
+        const SearchNodeInfo &info = search_node_infos[state];
+        bool tree_edge_in_heap = false;
+        for (Sap sap : incoming_heap[state]) {
+            const StateActionPair &edge = saps[sap];
+            if (edge.from == info.parent_state_id &&
+                edge.op_index == info.creating_operator)
+                tree_edge_in_heap = true;
+            edges.emplace_back(edge.from.get_value(),
+                               Edge {edge.to.get_value(),
+                                     get_plan_cost(edge.op_index),
+                                     edge.op_index});
+        }
+        if (info.parent_state_id != StateID::no_state && !tree_edge_in_heap) {
+            edges.emplace_back(info.parent_state_id.get_value(),
+                               Edge {(*it).get_value(),
+                                     get_plan_cost(info.creating_operator),
+                                     info.creating_operator});
+        }
+    }
+}
+
+// Adjacency lists by target (edges to the sources) or by source
+void PathSpace::build_adjacency(const EdgeList &edges, bool by_target,
+                                vector<size_t> &begin,
+                                vector<Edge> &adjacent) const {
+    begin.assign(num_states + 1, 0);
+    for (const pair<int, Edge> &edge : edges)
+        ++begin[(by_target ? edge.second.state : edge.first) + 1];
+    for (int state = 0; state < num_states; ++state)
+        begin[state + 1] += begin[state];
+    adjacent.resize(edges.size());
+    vector<size_t> next(begin.begin(), begin.end() - 1);
+    for (const pair<int, Edge> &edge : edges) {
+        Edge other = edge.second;
+        int state = edge.first;
+        if (by_target)
+            swap(state, other.state);
+        adjacent[next[state]++] = other;
+    }
+}
+
+// Dijkstra search from start, up to the bound, optionally without the
+// edges of an operator and without some states
+void PathSpace::compute_costs(const vector<size_t> &begin,
+                              const vector<Edge> &edges,
+                              int start, vector<int> &costs,
+                              int excluded_op,
+                              const vector<bool> *excluded_states) const {
+    costs.assign(num_states, -1);
+    priority_queues::AdaptiveQueue<int> queue;
+    if (!excluded_states || !(*excluded_states)[start])
+        queue.push(0, start);
+    while (!queue.empty()) {
+        pair<int, int> entry = queue.pop();
+        int cost = entry.first;
+        int state = entry.second;
+        if (costs[state] != -1)
+            continue;
+        costs[state] = cost;
+        for (size_t i = begin[state]; i < begin[state + 1]; ++i) {
+            const Edge &edge = edges[i];
+            if (edge.op_index == excluded_op ||
+                (excluded_states && (*excluded_states)[edge.state]))
+                continue;
+            if (costs[edge.state] == -1 && cost + edge.cost <= bound)
+                queue.push(cost + edge.cost, edge.state);
+        }
+    }
+}
+
+// Sort the states on plans within the bound such that all edges (or all
+// zero-cost edges) lead forward. Return false if there is a cycle.
+bool PathSpace::topological_order(bool zero_cost_only, vector<int> &sorted) const {
+    vector<int> in_degree(num_states, 0);
+    int num_on_plans = 0;
+    sorted.clear();
+    for (int state = 0; state < num_states; ++state) {
+        if (!is_on_plan(state))
+            continue;
+        ++num_on_plans;
+        for (size_t i = in_begin[state]; i < in_begin[state + 1]; ++i) {
+            if (!zero_cost_only || in_edges[i].cost == 0)
+                ++in_degree[state];
+        }
+        if (in_degree[state] == 0)
+            sorted.push_back(state);
+    }
+    for (size_t next = 0; next < sorted.size(); ++next) {
+        int state = sorted[next];
+        for (size_t i = out_begin[state]; i < out_begin[state + 1]; ++i) {
+            const Edge &edge = out_edges[i];
+            if ((!zero_cost_only || edge.cost == 0) && --in_degree[edge.state] == 0)
+                sorted.push_back(edge.state);
+        }
+    }
+    return static_cast<int>(sorted.size()) == num_on_plans;
+}
+
+/*
+  The forward count of a state and a cost is the sum of the counts of its
+  predecessors for the cost minus the cost of the edge. The costs are
+  processed in increasing order, and for each cost, the states whose
+  window contains it in topological order, so that predecessors via
+  zero-cost edges come first. Backward counts, of walks of a cost to the
+  goal state, are computed the same way on the reversed edges.
+*/
+void PathSpace::compute_counts(bool forward, vector<Count> &counts) const {
+    const vector<int> &start_cost = forward ? cost_from_init : cost_to_goal;
+    const vector<size_t> &begin = forward ? in_begin : out_begin;
+    const vector<Edge> &edges = forward ? in_edges : out_edges;
+    int source = forward ? initial_state : goal_state;
+
+    vector<int> rank(num_states, -1);
+    vector<vector<int>> window_start(bound + 1);
+    for (size_t i = 0; i < order.size(); ++i) {
+        int state = forward ? order[i] : order[order.size() - 1 - i];
+        rank[state] = i;
+        window_start[start_cost[state]].push_back(state);
+    }
+    counts.assign(num_counts, 0);
+
+    // States whose window contains the cost, in topological order
+    vector<int> active;
+    vector<int> next_active;
+    for (int cost = 0; cost <= bound; ++cost) {
+        const vector<int> &new_states = window_start[cost];
+        size_t j = 0;
+        next_active.clear();
+        for (int state : active) {
+            if (cost >= start_cost[state] + get_window_size(state))
+                continue;
+            while (j < new_states.size() && rank[new_states[j]] < rank[state])
+                next_active.push_back(new_states[j++]);
+            next_active.push_back(state);
+        }
+        next_active.insert(next_active.end(), new_states.begin() + j, new_states.end());
+        active.swap(next_active);
+        vector<int>().swap(window_start[cost]);
+
+        for (int state : active) {
+            Count count = (state == source && cost == 0) ? 1 : 0;
+            for (size_t i = begin[state]; i < begin[state + 1]; ++i) {
+                const Edge &edge = edges[i];
+                int pred_cost = cost - edge.cost;
+                if (pred_cost >= start_cost[edge.state] &&
+                    pred_cost < start_cost[edge.state] + get_window_size(edge.state)) {
+                    count = add_counts(count, counts[
+                        counts_begin[edge.state] + pred_cost - start_cost[edge.state]]);
+                }
+            }
+            counts[counts_begin[state] + cost - start_cost[state]] = count;
+        }
+    }
+}
+
+PathSpace::Count PathSpace::count_plans(int cost) const {
+    assert(!zero_cost_cycle);
+    assert(cost <= bound);
+    if (!is_on_plan(goal_state) || !in_window(goal_state, cost))
+        return 0;
+    return get_forward_count(goal_state, cost);
+}
+
+void PathSpace::count_simple_plans(vector<Count> &histogram) const {
+    histogram.resize(bound + 1, 0);
+    if (!is_on_plan(initial_state))
+        return;
+    vector<bool> on_path(num_states, false);
+    count_simple_plans(initial_state, 0, on_path, histogram);
+}
+
+void PathSpace::count_simple_plans(int state, int cost, vector<bool> &on_path,
+                                   vector<Count> &histogram) const {
+    if (state == goal_state) {
+        histogram[cost] = add_counts(histogram[cost], 1);
+        return;
+    }
+    on_path[state] = true;
+    for (size_t i = out_begin[state]; i < out_begin[state + 1]; ++i) {
+        const Edge &edge = out_edges[i];
+        int succ_cost = cost + edge.cost;
+        if (!on_path[edge.state] && succ_cost + cost_to_goal[edge.state] <= bound)
+            count_simple_plans(edge.state, succ_cost, on_path, histogram);
+    }
+    on_path[state] = false;
+}
+
+bool PathSpace::sample_plan(int cost, utils::RandomNumberGenerator &rng,
+                            bool simple_only, Plan &plan) const {
+    assert(!zero_cost_cycle);
+    plan.clear();
+    if (count_plans(cost) == 0)
+        return false;
+    vector<int> states;
+    vector<Count> weights;
+    int state = goal_state;
+    while (true) {
+        states.push_back(state);
+        // The last weight is the one of the empty walk
+        weights.clear();
+        for (size_t i = in_begin[state]; i < in_begin[state + 1]; ++i) {
+            const Edge &edge = in_edges[i];
+            int pred_cost = cost - edge.cost;
+            weights.push_back(in_window(edge.state, pred_cost) ?
+                              get_forward_count(edge.state, pred_cost) : 0);
+        }
+        weights.push_back((state == initial_state && cost == 0) ? 1 : 0);
+        size_t chosen = choose_weighted(weights, rng);
+        if (chosen == weights.size() - 1)
+            break;
+        const Edge &edge = in_edges[in_begin[state] + chosen];
+        if (!is_goal_operator(edge.op_index))
+            plan.push_back(&g_operators[edge.op_index]);
+        state = edge.state;
+        cost -= edge.cost;
+    }
+    reverse(plan.begin(), plan.end());
+    if (simple_only) {
+        sort(states.begin(), states.end());
+        if (adjacent_find(states.begin(), states.end()) != states.end())
+            return false;
+    }
+    return true;
+}
+
+/*
+  Draws from [0, total) with the random double of the generator, which
+  is exact up to 2^53. Beyond that, and for saturated counts, the draw
+  is only close to uniform.
+*/
+size_t PathSpace::choose_weighted(const vector<Count> &weights,
+                                  utils::RandomNumberGenerator &rng) {
+    Count total = 0;
+    for (Count weight : weights)
+        total = add_counts(total, weight);
+    assert(total > 0);
+    Count drawn = static_cast<Count>(rng() * static_cast<double>(total));
+    drawn = min(drawn, total - 1);
+    size_t i = 0;
+    while (drawn >= weights[i])
+        drawn -= weights[i++];
+    return i;
+}
+
+static PathSpace::Count multiply_counts(PathSpace::Count lhs,
+                                        PathSpace::Count rhs) {
+    if (lhs != 0 && rhs > PathSpace::MAX_COUNT / lhs)
+        return PathSpace::MAX_COUNT;
+    return lhs * rhs;
+}
+
+/*
+  A state on a walk of cost c from the initial state continues to the
+  goal by any walk of cost at most bound - c. Summing over c the number
+  of walks to the state times the number of these continuations gives
+  its visits, and likewise for an edge with its cost added.
+*/
+void PathSpace::count_occurrences(vector<Count> &op_occurrences,
+                                  vector<Count> &state_visits) const {
+    assert(!zero_cost_cycle);
+    op_occurrences.assign(g_operators.size() - 1, 0);
+    state_visits.assign(num_states, 0);
+    // Numbers of walks to the goal state of at most each cost
+    vector<Count> to_goal;
+    compute_counts(false, to_goal);
+    for (int state : order) {
+        size_t first = counts_begin[state];
+        for (int i = 1; i < get_window_size(state); ++i)
+            to_goal[first + i] = add_counts(to_goal[first + i], to_goal[first + i - 1]);
+    }
+    auto count_to_goal = [&](int state, int max_cost) -> Count {
+        if (max_cost < cost_to_goal[state])
+            return 0;
+        int offset = min(max_cost - cost_to_goal[state], get_window_size(state) - 1);
+        return to_goal[counts_begin[state] + offset];
+    };
+
+    for (int state : order) {
+        for (int cost = cost_from_init[state]; cost <= bound - cost_to_goal[state]; ++cost) {
+            Count walks = get_forward_count(state, cost);
+            if (walks == 0)
+                continue;
+            state_visits[state] = add_counts(
+                state_visits[state],
+                multiply_counts(walks, count_to_goal(state, bound - cost)));
+            for (size_t i = out_begin[state]; i < out_begin[state + 1]; ++i) {
+                const Edge &edge = out_edges[i];
+                if (is_goal_operator(edge.op_index))
+                    continue;
+                Count continuations = count_to_goal(edge.state, bound - cost - edge.cost);
+                op_occurrences[edge.op_index] = add_counts(
+                    op_occurrences[edge.op_index],
+                    multiply_counts(walks, continuations));
+            }
+        }
+    }
+}
+
+bool PathSpace::has_plan_without_operator(int op_index) const {
+    vector<int> costs;
+    compute_costs(out_begin, out_edges, initial_state, costs, op_index);
+    return costs[goal_state] != -1;
+}
+
+bool PathSpace::has_plan_without_states(const vector<bool> &excluded) const {
+    vector<int> costs;
+    compute_costs(out_begin, out_edges, initial_state, costs, -1, &excluded);
+    return costs[goal_state] != -1;
+}
+
+void PathSpace::export_graph(explored_graph::ExploredGraph &graph) const {
+    graph.flags = zero_cost_cycle ? explored_graph::FLAG_ZERO_COST_CYCLE : 0;
+    graph.bound = bound;
+    graph.operator_names.clear();
+    graph.operator_costs.clear();
+    for (size_t op_index = 0; op_index + 1 < g_operators.size(); ++op_index) {
+        graph.operator_names.push_back(g_operators[op_index].get_name());
+        graph.operator_costs.push_back(get_plan_cost(op_index));
+    }
+
+    vector<int> number(num_states, -1);
+    graph.cost_from_init.clear();
+    graph.cost_to_goal.clear();
+    for (int state = 0; state < num_states; ++state) {
+        if (!is_on_plan(state))
+            continue;
+        number[state] = graph.cost_from_init.size();
+        graph.cost_from_init.push_back(cost_from_init[state]);
+        graph.cost_to_goal.push_back(cost_to_goal[state]);
+    }
+    graph.initial_state = number[initial_state];
+    graph.goal_state = number[goal_state];
+    graph.edges.clear();
+    for (int state = 0; state < num_states; ++state) {
+        for (size_t i = out_begin[state]; i < out_begin[state + 1]; ++i) {
+            const Edge &edge = out_edges[i];
+            int op = is_goal_operator(edge.op_index) ? -1 : edge.op_index;
+            graph.edges.push_back({number[state], number[edge.state], op});
+        }
+    }
+}
+}
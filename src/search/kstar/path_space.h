@@ -0,0 +1,169 @@
+#ifndef KSTAR_PATH_SPACE_H
+#define KSTAR_PATH_SPACE_H
+
+#include "kstar_types.h"
+
+#include "../per_state_information.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace explored_graph {
+class ExploredGraph;
+}
+
+namespace utils {
+class RandomNumberGenerator;
+}
+
+namespace kstar {
+/*
+  The plans of cost at most bound in the state space explored by A*:
+  the walks from the initial state to the goal state along the edges of
+  the incoming heaps and the shortest path tree. These are the plans K*
+  enumerates without skip_reorderings and simple_plans_only.
+
+  Plans are counted by dynamic programming over pairs of a state and the
+  cost of a walk to it. Only costs that still allow to reach the goal
+  within the bound are considered, and the pairs are processed in the
+  order of their costs, so cycles of positive cost need no special
+  treatment. Time and memory are linear in the size of the explored
+  graph times the bound, independent of the number of plans.
+
+  Costs are operator costs without the artificial goal operator.
+*/
+class PathSpace {
+public:
+    // Numbers of plans saturate at MAX_COUNT
+    typedef uint64_t Count;
+    static const Count MAX_COUNT = UINT64_MAX;
+private:
+    struct Edge {
+        // The other end of the edge
+        int state;
+        int cost;
+        int op_index;
+    };
+
+    const int bound;
+    // States are indexed by the values of their ids
+    const int num_states;
+    int initial_state;
+    int goal_state;
+    // Cost of the cheapest walk from the initial state and to the goal
+    // state, -1 if there is none
+    std::vector<int> cost_from_init;
+    std::vector<int> cost_to_goal;
+    // Edges on plans within the bound, by target and by source
+    std::vector<size_t> in_begin;
+    std::vector<Edge> in_edges;
+    std::vector<size_t> out_begin;
+    std::vector<Edge> out_edges;
+    // States on plans within the bound, ordered such that zero-cost
+    // edges lead forward. Incomplete if there is a zero-cost cycle.
+    std::vector<int> order;
+    bool zero_cost_cycle;
+    bool cycle;
+    // Number of walks from the initial state to each state on plans
+    // within the bound, for each cost of its window (see get_window_size)
+    std::vector<size_t> counts_begin;
+    size_t num_counts;
+    std::vector<Count> forward_counts;
+
+    // Edges as pairs of their source and the edge to their target
+    typedef std::vector<std::pair<int, Edge>> EdgeList;
+
+    void collect_edges(const StateRegistry &state_registry,
+                       const SearchSpace &search_space,
+                       const SapArena &saps,
+                       const PerStateInformation<std::vector<Sap>> &incoming_heap,
+                       EdgeList &edges) const;
+    void build_adjacency(const EdgeList &edges, bool by_target,
+                         std::vector<size_t> &begin,
+                         std::vector<Edge> &adjacent) const;
+    void compute_costs(const std::vector<size_t> &begin,
+                       const std::vector<Edge> &edges,
+                       int start, std::vector<int> &costs,
+                       int excluded_op = -1,
+                       const std::vector<bool> *excluded_states = nullptr) const;
+    bool topological_order(bool zero_cost_only,
+                           std::vector<int> &sorted) const;
+    void compute_counts(bool forward, std::vector<Count> &counts) const;
+    void count_simple_plans(int state, int cost, std::vector<bool> &on_path,
+                            std::vector<Count> &histogram) const;
+    Count get_forward_count(int state, int cost) const {
+        return forward_counts[counts_begin[state] + cost - cost_from_init[state]];
+    }
+
+    bool is_on_plan(int state) const {
+        return cost_from_init[state] != -1 && cost_to_goal[state] != -1 &&
+               cost_from_init[state] + cost_to_goal[state] <= bound;
+    }
+    // Costs from cost_from_init[state] to bound - cost_to_goal[state]
+    int get_window_size(int state) const {
+        return bound - cost_to_goal[state] - cost_from_init[state] + 1;
+    }
+    bool in_window(int state, int cost) const {
+        return cost >= cost_from_init[state] &&
+               cost <= bound - cost_to_goal[state];
+    }
+public:
+    PathSpace(StateRegistry &state_registry,
+              const SearchSpace &search_space,
+              const SapArena &saps,
+              const PerStateInformation<std::vector<Sap>> &incoming_heap,
+              StateID goal_state,
+              int bound);
+
+    static Count add_counts(Count lhs, Count rhs) {
+        return lhs > MAX_COUNT - rhs ? MAX_COUNT : lhs + rhs;
+    }
+
+    int get_bound() const {
+        return bound;
+    }
+    // Whether plans within the bound can revisit states
+    bool has_cycles() const {
+        return cycle;
+    }
+    // Whether a zero-cost cycle lies on plans within the bound
+    bool has_infinitely_many_plans() const {
+        return zero_cost_cycle;
+    }
+    // Number of plans of the given cost, which must be at most the bound
+    Count count_plans(int cost) const;
+    // Add the number of plans that do not revisit states to the
+    // histogram by their cost. This enumerates the plans.
+    void count_simple_plans(std::vector<Count> &histogram) const;
+    /*
+      Draw one of the plans of the given cost uniformly at random by a
+      random walk backwards from the goal state, guided by the numbers of
+      walks to each state. The time is linear in the length of the plan
+      times the in-degree of its states. Return false if there is no plan
+      of this cost, or if simple_only is set and the walk revisits a state.
+    */
+    bool sample_plan(int cost, utils::RandomNumberGenerator &rng,
+                     bool simple_only, Plan &plan) const;
+    /*
+      Count how often each operator and each state occurs on all plans
+      together, where a plan that visits a state twice counts twice.
+      Operators are indexed by their index, without the artificial goal
+      operator, and states by the values of their ids.
+    */
+    void count_occurrences(std::vector<Count> &op_occurrences,
+                           std::vector<Count> &state_visits) const;
+    // Whether some plan within the bound does not use the operator
+    bool has_plan_without_operator(int op_index) const;
+    // Whether some plan within the bound visits none of the states
+    // (indexed by the values of their ids)
+    bool has_plan_without_states(const std::vector<bool> &excluded) const;
+    // Store the states and edges on plans within the bound in the graph,
+    // with the states numbered consecutively
+    void export_graph(explored_graph::ExploredGraph &graph) const;
+    // Index drawn with probability proportional to its weight
+    static size_t choose_weighted(const std::vector<Count> &weights,
+                                  utils::RandomNumberGenerator &rng);
+};
+}
+
+#endif
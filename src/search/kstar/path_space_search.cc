@@ -0,0 +1,77 @@
+#include "path_space_search.h"
+
+#include "kstar.h"
+#include "path_space.h"
+
+#include "../option_parser.h"
+#include "../search_engines/search_common.h"
+#include "../utils/countdown_timer.h"
+
+using namespace std;
+
+namespace kstar {
+PathSpaceSearch::PathSpaceSearch(const options::Options &opts)
+    : TopKEagerSearch(opts),
+      optimal_solution_cost(-1),
+      plan_cost_bound(-1) {
+}
+
+void PathSpaceSearch::search() {
+    initialize();
+    utils::CountdownTimer timer(max_time);
+    // A* expands the states in the order of their f-values, which include
+    // the cost of the goal operator. All states on plans within the bound
+    // are expanded before any state with a higher f-value.
+    while (!all_nodes_expanded &&
+           (plan_cost_bound == -1 || next_node_f <= plan_cost_bound + 1)) {
+        step();
+        if (timer.is_expired()) {
+            cout << "Time limit reached. Aborting search." << endl;
+            status = TIMEOUT;
+            return;
+        }
+        if (first_plan_found && plan_cost_bound == -1) {
+            GlobalState goal = state_registry.lookup_state(goal_state);
+            optimal_solution_cost = search_space.search_node_infos[goal].real_g - 1;
+            plan_cost_bound = (int) ((optimal_solution_cost * quality_bound) + 0.00001);
+        }
+    }
+    if (!first_plan_found) {
+        cout << "No plan found" << endl;
+        status = FAILED;
+        return;
+    }
+
+    utils::Timer analysis_timer;
+    PathSpace path_space(state_registry, search_space, saps, incomming_heap,
+                         goal_state, plan_cost_bound);
+    analyze(path_space);
+    cout << "Plan analysis time: " << analysis_timer << endl;
+    status = SOLVED;
+    solution_found = true;
+    cout << "Actual search time: " << timer
+         << " [t=" << utils::g_timer << "]" << endl;
+}
+
+void add_path_space_search_options(OptionParser &parser) {
+    parser.add_option<ScalarEvaluator *>("eval", "evaluator for h-value");
+    parser.add_option<double>(
+        "q",
+        "Quality bound multiplier (of optimal solution cost)",
+        "1.0",
+        Bounds("1.0", "infinity"));
+    add_verbosity_option(parser);
+    top_k_eager_search::add_pruning_option(parser);
+    SearchEngine::add_options_to_parser(parser);
+}
+
+void set_path_space_search_options(options::Options &opts) {
+    auto temp = search_common::create_astar_open_list_factory_and_f_eval(opts);
+    opts.set("open", temp.first);
+    opts.set("f_eval", temp.second);
+    opts.set("reopen_closed", true);
+    vector<Heuristic *> preferred_list;
+    opts.set("preferred", preferred_list);
+    opts.set("k", -1);
+}
+}
@@ -0,0 +1,33 @@
+#ifndef KSTAR_PATH_SPACE_SEARCH_H
+#define KSTAR_PATH_SPACE_SEARCH_H
+
+#include "../search_engines/top_k_eager_search.h"
+
+namespace kstar {
+class PathSpace;
+
+/*
+  Base of the engines that answer questions about all plans of cost at
+  most q times the optimal cost without enumerating them. A* explores
+  the states on these plans like for K*, and the plans are analyzed on
+  the path space of the explored graph (see path_space.h).
+*/
+class PathSpaceSearch : public top_k_eager_search::TopKEagerSearch {
+protected:
+    int optimal_solution_cost;
+    // Highest cost of the plans analyzed, -1 before the first plan is found
+    int plan_cost_bound;
+
+    virtual void analyze(const PathSpace &path_space) = 0;
+public:
+    explicit PathSpaceSearch(const options::Options &opts);
+    virtual ~PathSpaceSearch() = default;
+    virtual void search() override;
+};
+
+void add_path_space_search_options(OptionParser &parser);
+// Set the options of the A* search, which are not given by the user
+void set_path_space_search_options(options::Options &opts);
+}
+
+#endif
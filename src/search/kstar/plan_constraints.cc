@@ -0,0 +1,103 @@
+#include "plan_constraints.h"
+
+#include "util.h"
+
+#include "../globals.h"
+#include "../option_parser.h"
+
+#include "../utils/system.h"
+
+#include <algorithm>
+#include <fstream>
+
+using namespace std;
+
+namespace kstar {
+PlanConstraints::PlanConstraints(const Options &opts)
+    : num_required(0) {
+    vector<int> op_indices;
+    if (opts.contains("forbidden_operators")) {
+        read_operators(opts.get<string>("forbidden_operators"), op_indices);
+        forbidden.assign(g_operators.size(), false);
+        for (int op_index : op_indices)
+            forbidden[op_index] = true;
+    }
+    if (opts.contains("required_operators")) {
+        read_operators(opts.get<string>("required_operators"), op_indices);
+        required_index.assign(g_operators.size(), -1);
+        for (int op_index : op_indices) {
+            if (required_index[op_index] == -1)
+                required_index[op_index] = num_required++;
+        }
+    }
+}
+
+/*
+  One operator name per line, with or without the parentheses of plan
+  files. Empty lines and comments (starting with ;) are skipped, so a
+  plan file can be given as well.
+*/
+void PlanConstraints::read_operators(const string &filename,
+                                     vector<int> &op_indices) const {
+    ifstream in(filename);
+    if (!in) {
+        cerr << "Could not open operator file " << filename << endl;
+        utils::exit_with(utils::ExitCode::INPUT_ERROR);
+    }
+    op_indices.clear();
+    string line;
+    while (getline(in, line)) {
+        size_t begin = line.find_first_not_of(" \t\r(");
+        if (begin == string::npos || line[begin] == ';')
+            continue;
+        int op_index = find_operator(line);
+        if (op_index == -1) {
+            cerr << "Unknown operator " << line << " in " << filename << endl;
+            utils::exit_with(utils::ExitCode::INPUT_ERROR);
+        }
+        op_indices.push_back(op_index);
+    }
+}
+
+void PlanConstraints::remove_forbidden(vector<const GlobalOperator *> &ops) const {
+    if (forbidden.empty())
+        return;
+    ops.erase(remove_if(ops.begin(), ops.end(),
+                        [this](const GlobalOperator *op) {
+                            return forbidden[op->get_index()];
+                        }),
+              ops.end());
+}
+
+bool PlanConstraints::uses_required_operators(const Plan &plan) const {
+    if (num_required == 0)
+        return true;
+    vector<bool> used(num_required, false);
+    int num_used = 0;
+    for (const GlobalOperator *op : plan) {
+        int index = required_index[op->get_index()];
+        if (index != -1 && !used[index]) {
+            used[index] = true;
+            if (++num_used == num_required)
+                return true;
+        }
+    }
+    return false;
+}
+
+void add_plan_constraint_options(OptionParser &parser) {
+    parser.add_option<string>(
+        "forbidden_operators",
+        "A path to a file with the names of operators that plans must not "
+        "use, one per line. A* does not apply them.",
+        OptionParser::NONE);
+    parser.add_option<string>(
+        "required_operators",
+        "A path to a file with the names of operators that plans must all "
+        "use, one per line. Plans without one of them are skipped before "
+        "they are reconstructed and do not count towards k. The quality "
+        "bound stays relative to the cheapest plan without forbidden "
+        "operators.",
+        OptionParser::NONE);
+}
+}
@@ -0,0 +1,48 @@
+#ifndef KSTAR_PLAN_CONSTRAINTS_H
+#define KSTAR_PLAN_CONSTRAINTS_H
+
+#include "kstar_types.h"
+
+#include <string>
+#include <vector>
+
+class GlobalOperator;
+
+namespace options {
+class OptionParser;
+class Options;
+}
+
+namespace kstar {
+/*
+  Operators that plans must not use and operators that plans must use.
+  A* never applies forbidden operators, so the explored graph has no
+  edges with them. Required operators are checked on the path graph
+  node of each plan before the plan is reconstructed.
+*/
+class PlanConstraints {
+    std::vector<bool> forbidden;
+    // Index of each operator among the required ones, -1 if not required
+    std::vector<int> required_index;
+    int num_required;
+
+    void read_operators(const std::string &filename,
+                        std::vector<int> &op_indices) const;
+public:
+    explicit PlanConstraints(const options::Options &opts);
+
+    bool has_forbidden_operators() const {
+        return !forbidden.empty();
+    }
+    bool has_required_operators() const {
+        return num_required > 0;
+    }
+    void remove_forbidden(std::vector<const GlobalOperator *> &ops) const;
+    // Whether the plan uses all required operators
+    bool uses_required_operators(const Plan &plan) const;
+};
+
+void add_plan_constraint_options(options::OptionParser &parser);
+}
+
+#endif
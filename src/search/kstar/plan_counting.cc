@@ -0,0 +1,109 @@
+#include "plan_counting.h"
+
+#include "kstar.h"
+#include "path_space.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+#include <fstream>
+
+using namespace std;
+
+namespace kstar {
+PlanCounting::PlanCounting(const options::Options &opts)
+    : PathSpaceSearch(opts),
+      simple_plans_only(opts.get<bool>("simple_plans_only")) {
+    if (opts.contains("json_file_to_dump"))
+        json_filename = opts.get<string>("json_file_to_dump");
+}
+
+static string count_to_string(PathSpace::Count count) {
+    if (count == PathSpace::MAX_COUNT)
+        return "at least " + to_string(count);
+    return to_string(count);
+}
+
+void PlanCounting::analyze(const PathSpace &path_space) {
+    int bound = path_space.get_bound();
+    bool infinite = false;
+    vector<PathSpace::Count> histogram(bound + 1, 0);
+    // Counting the plans that do not revisit states is hard in general,
+    // but easy if no plan within the bound can revisit a state
+    if (simple_plans_only && path_space.has_cycles()) {
+        cout << "Plans within the bound can revisit states, "
+             << "enumerating the simple plans" << endl;
+        path_space.count_simple_plans(histogram);
+    } else if (path_space.has_infinitely_many_plans()) {
+        infinite = true;
+    } else {
+        for (int cost = 0; cost <= bound; ++cost)
+            histogram[cost] = path_space.count_plans(cost);
+    }
+
+    PathSpace::Count total = 0;
+    for (PathSpace::Count count : histogram)
+        total = PathSpace::add_counts(total, count);
+    if (infinite) {
+        cout << "Infinitely many plans of cost at most " << bound
+             << ", a zero-cost cycle lies on them" << endl;
+    } else {
+        for (int cost = 0; cost <= bound; ++cost) {
+            if (histogram[cost] > 0) {
+                cout << "Plans of cost " << cost << ": "
+                     << count_to_string(histogram[cost]) << endl;
+            }
+        }
+        cout << "Plans of cost at most " << bound << ": "
+             << count_to_string(total) << endl;
+    }
+
+    if (!json_filename.empty()) {
+        ofstream os(json_filename.c_str());
+        os << "{ \"optimal_cost\" : " << optimal_solution_cost << "," << endl;
+        os << "\"bound\" : " << bound << "," << endl;
+        os << "\"infinite\" : " << (infinite ? "true" : "false") << "," << endl;
+        os << "\"saturated\" : "
+           << (total == PathSpace::MAX_COUNT ? "true" : "false") << "," << endl;
+        os << "\"plans\" : " << total << "," << endl;
+        os << "\"histogram\" : [" << endl;
+        bool first = true;
+        for (int cost = 0; cost <= bound; ++cost) {
+            if (histogram[cost] == 0)
+                continue;
+            if (!first)
+                os << "," << endl;
+            os << "{ \"cost\" : " << cost << ", \"plans\" : " << histogram[cost] << "}";
+            first = false;
+        }
+        os << "]}" << endl;
+    }
+}
+
+static SearchEngine *_parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Plan counting",
+        "Counts the plans of cost at most q times the optimal cost by "
+        "their cost, without enumerating them. These are the plans that "
+        "kstar finds with the same q. The plans are counted by dynamic "
+        "programming over the states that A* explores and the costs up to "
+        "the bound, so the time does not depend on the number of plans. "
+        "With simple_plans_only, the plans are enumerated instead if some "
+        "plan within the bound revisits a state.");
+    add_path_space_search_options(parser);
+    add_simple_plans_only_option(parser);
+    parser.add_option<string>("json_file_to_dump",
+        "A path to the json file to dump the counts to",
+        OptionParser::NONE);
+    Options opts = parser.parse();
+
+    PlanCounting *engine = nullptr;
+    if (!parser.dry_run()) {
+        set_path_space_search_options(opts);
+        engine = new PlanCounting(opts);
+    }
+    return engine;
+}
+
+static Plugin<SearchEngine> _plugin("kstar_count", _parse);
+}
@@ -0,0 +1,21 @@
+#ifndef KSTAR_PLAN_COUNTING_H
+#define KSTAR_PLAN_COUNTING_H
+
+#include "path_space_search.h"
+
+#include <string>
+
+namespace kstar {
+// Count the plans of cost at most q times the optimal cost by their cost
+class PlanCounting : public PathSpaceSearch {
+    const bool simple_plans_only;
+    std::string json_filename;
+protected:
+    virtual void analyze(const PathSpace &path_space) override;
+public:
+    explicit PlanCounting(const options::Options &opts);
+    virtual ~PlanCounting() = default;
+};
+}
+
+#endif
@@ -1,106 +1,116 @@
 #include "plan_reconstructor.h"
+#include "checkpoint.h"
+#include "ordered_worker_pool.h"
+#include "plan_set_writer.h"
 #include "util.h"
+#include "../utils/json.h"
 
 #include <dirent.h>
 #include <sys/stat.h>
 #include <fstream>
 #include <iostream>
+#include <random>
 #include <sstream>
 #include "../successor_generator.h"
 #include "../globals.h"
 
 namespace kstar {
 
-PlanReconstructor::PlanReconstructor(std::unordered_map<Node, Node>& parent_sap,
-                                      std::unordered_set<Edge>& cross_edge,
+PlanReconstructor::PlanReconstructor(const SapArena &saps,
+                                      const PathGraph &path_graph,
                                       StateID goal_state,
                                       StateRegistry* state_registry,
                                       SearchSpace* search_space,
                                       bool skip_reorderings,     
                                       bool dump_plans,
+                                      unique_ptr<PlanSink> plan_sink,
+                                      int num_threads,
                                       Verbosity verbosity) :
-                                              parent_node(parent_sap),
-                                              cross_edge(cross_edge),
+                                              saps(saps),
+                                              path_graph(path_graph),
                                               goal_state(goal_state),
                                               state_registry(state_registry),
                                               search_space(search_space),
                                               skip_reorderings(skip_reorderings), 
                                               dump_plans(dump_plans),
+                                              plan_sink(move(plan_sink)),
+                                              num_threads(num_threads),
                                               verbosity(verbosity), 
                                               attempted_plans(0), 
                                               last_plan_cost(-1), 
                                               best_plan_cost(-1), 
-                                              number_of_kept_plans(0) {
+                                              root_plan_cost(-1),
+                                              number_of_kept_plans(0),
+                                              refound_cost(-1),
+                                              seen_in_check(-1),
+                                              simple_plan_checks(0) {
+    plan_writer.reset(new OrderedWorkerPool<PendingPlan>(
+        get_num_workers(false), 256 * num_threads,
+        [this](PendingPlan &pending) {
+            if (pending.materialized)
+                return;
+            // The sidetracks are taken from the path graph by add_plan,
+            // since the Dijkstra search extends it meanwhile
+            pending.plan.clear();
+            StateSequence state_seq;
+            extract_plan(pending.sidetracks, pending.plan, state_seq);
+            pending.plan.pop_back();
+            assert(pending.cost == calculate_plan_cost(pending.plan));
+        },
+        [this](PendingPlan &pending) {
+            write_plan(pending.plan, pending.cost);
+        }));
+    if (skip_reorderings) {
+        // Fixed seed, so that runs are reproducible
+        mt19937_64 rng(2020);
+        for (size_t i = 0; i < g_operators.size(); ++i)
+            operator_keys.push_back(rng());
+    }
 }
 
+// The plans found so far are written already and stay valid, so they
+// are kept. The restarted search finds them again, and add_plan skips
+// them by comparing the plans up to refound_cost with the kept ones.
 void PlanReconstructor::clear() {
+    // Lazy plans are materialized before the tree changes
+    assert(lazy_plans.empty());
     attempted_plans = 0;
-    for (auto& plans : kept_plans) {
-        if (plans.first == best_plan_cost) {
-            // Keeping only the optimal plans
-            number_of_kept_plans = plans.second.size();
-            if (skip_reorderings) {
-                // Kept plans, unordered 
-                accepted_plans.clear();
-                for (auto& plan : plans.second) {
-                    // copying the plan, sorting the actions, adding to the set.
-                    Plan unordered_plan = plan;
-                    std::sort(unordered_plan.begin(), unordered_plan.end());
-	                accepted_plans.insert(unordered_plan);
-                }
-            }
-            continue;
-        }
-        plans.second.clear();
-    }
+    refound_cost = max(refound_cost, last_plan_cost);
 }
 
 void PlanReconstructor::set_goal_state(StateID goal_state) {
     this->goal_state = goal_state;
 }
 
-std::vector<Node> PlanReconstructor::djkstra_traceback(Node node)    {
-    vector<Node> path;
-    Node current_sap = node;
-    for(;;) {
-        path.push_back(current_sap);
-        if(!current_sap.sap->op) {
-            break;
-        }
-        current_sap = parent_node.at(current_sap);
-    }
-    reverse(path.begin(), path.end());
-    return path;
-}
-
-vector<Node> PlanReconstructor::compute_sidetrack_seq(vector<Node>& path) {
-    vector<Node> seq;
-    int last_index = path.size() - 1;
-    Node last_element = path[last_index];
-    seq.push_back(last_element);
-
-    for (size_t i = last_index; i >= 2; --i) {
-       Edge e(path[i-1], path[i]);
-
-        if(cross_edge.find(e) != cross_edge.end()) {
-            seq.push_back(path[i - 1]);
-        }
+// Follow the parent pointers from node to the root of the path graph.
+// The sidetrack sequence consists of the edge of node and the edges of
+// all nodes left via a cross edge, except for the root.
+void PlanReconstructor::compute_sidetrack_seq(NodeID node,
+                                              vector<Sap> &seq) const {
+    if (path_graph[node].parent == PathGraph::NO_NODE)
+        return;
+    seq.push_back(path_graph[node].sap);
+    NodeID current = node;
+    NodeID parent = path_graph[current].parent;
+    while (path_graph[parent].parent != PathGraph::NO_NODE) {
+        if (path_graph[current].cross_edge)
+            seq.push_back(path_graph[parent].sap);
+        current = parent;
+        parent = path_graph[current].parent;
     }
     reverse(seq.begin(), seq.end());
-    return seq;
-
 }
 
-void PlanReconstructor::extract_plan(vector<Node> &seq,
+void PlanReconstructor::extract_plan(vector<Sap> &seq,
                                     Plan &plan,
-                                    StateSequence &state_seq) {
+                                    StateSequence &state_seq) const {
 
     GlobalState current_state = state_registry->lookup_state(goal_state);
     state_seq.push_back(current_state.get_id());
     int seq_index = 0;
     int seq_size = seq.size();
     for(;;) {
-        const SearchNodeInfo &info = search_space->search_node_infos[current_state];
+        const SearchNodeInfo &info = search_space->get_node_info(current_state);
         // Initial state reached and all edges of seq consumed
         if (info.creating_operator == -1 && seq_index == seq_size) {
             assert(info.parent_state_id == StateID::no_state);
@@ -108,10 +118,10 @@ void PlanReconstructor::extract_plan(vector<Node> &seq,
         }
 
         // second last edge in seq and attachable to what we already have
-        if(seq_index <= seq_size - 1 && seq[seq_index].sap->to == current_state.get_id()) {
+        if(seq_index <= seq_size - 1 && saps[seq[seq_index]].to == current_state.get_id()) {
             // prepend edge from seq
-            plan.push_back(seq[seq_index].sap->op);
-            current_state = state_registry->lookup_state(seq[seq_index].sap->from);
+            plan.push_back(saps.get_op(seq[seq_index]));
+            current_state = saps.get_from_state(seq[seq_index]);
             ++seq_index;
         }
         else {
@@ -144,18 +154,41 @@ void PlanReconstructor::extract_plan(vector<Node> &seq,
     reverse(state_seq.begin(), state_seq.end());
 }
 
-bool PlanReconstructor::is_simple_plan(StateSequence seq, StateRegistry* state_registry) {
-    PerStateInformation<bool> seen;
-    for (size_t i = 0; i < seq.size(); ++i) {
-        GlobalState s = state_registry->lookup_state(seq[i]);
-        if (!seen[s]) {
-           seen[s] = true;
+// Walk the states of the plan of node like extract_plan does, without
+// building the plan. The descendants of node replace its edge or add
+// sidetracks behind it, so they all share the part of the plan from the
+// goal back to the source of the second to last sidetrack.
+Revisit PlanReconstructor::find_revisit(NodeID node) {
+    vector<Sap> seq;
+    compute_sidetrack_seq(node, seq);
+    int seq_index = 0;
+    int seq_size = seq.size();
+    int shared = seq_size - 1;
+
+    ++simple_plan_checks;
+    GlobalState current_state = state_registry->lookup_state(goal_state);
+    seen_in_check[current_state] = simple_plan_checks;
+    for (;;) {
+        const SearchNodeInfo &info = search_space->get_node_info(current_state);
+        if (info.creating_operator == -1 && seq_index == seq_size)
+            break;
+        bool sidetrack = seq_index < seq_size
+            && saps[seq[seq_index]].to == current_state.get_id();
+        if (sidetrack) {
+            current_state = saps.get_from_state(seq[seq_index]);
+            ++seq_index;
+        } else {
+            current_state = state_registry->lookup_state(info.parent_state_id);
         }
-        else {
-           return false;
+        int &seen = seen_in_check[current_state];
+        if (seen == simple_plan_checks) {
+            if (seq_index < shared || (sidetrack && seq_index == shared))
+                return Revisit::SUBTREE;
+            return Revisit::NODE;
         }
+        seen = simple_plan_checks;
     }
-    return true;
+    return Revisit::NONE;
 }
 void PlanReconstructor::check_set_best_plan(int cost) {
     if (best_plan_cost == -1) {
@@ -165,33 +198,119 @@ void PlanReconstructor::check_set_best_plan(int cost) {
         cerr << "ERROR added cheaper than optimal plan";
 }
 
-bool PlanReconstructor::add_plan(Node node, bool simple_plans_only) {
+void PlanReconstructor::reset() {
+    attempted_plans = 0;
+    lazy_plans.clear();
+    kept_plans.clear();
+    accepted_plans.clear();
+    accepted_operators.clear();
+    last_plan_cost = -1;
+    best_plan_cost = -1;
+    root_plan_cost = -1;
+    number_of_kept_plans = 0;
+    refound_cost = -1;
+}
+
+bool PlanReconstructor::add_plan(Node node) {
     // Returns a boolean whether the plan was added
     attempted_plans++;
     if (attempted_plans % 10000 == 0) {
         printf ("Attempted plans: %4.2fM\n", attempted_plans / 1000000.0);
     }
-    vector<Node> path = djkstra_traceback(node);
-    vector<Node> seq;
+    // The sidetracks of node add node.g to the cost of the root plan
+    bool is_root = path_graph[node.id].parent == PathGraph::NO_NODE;
+    int cost = is_root ? -1 : root_plan_cost + node.g;
+
+    Fingerprint fingerprint = {0, 0};
+    if (skip_reorderings) {
+        collect_operators(node.id, checked_plan);
+        fingerprint = compute_fingerprint(checked_plan);
+        if (is_duplicate(checked_plan, fingerprint))
+            return false;
+    }
 
-    if (path.size() > 1) {
-         seq = compute_sidetrack_seq(path);
+    // Optimal plans and plans that may have been found before a restart
+    // are kept in full, otherwise the plan is kept lazily. Every plan is
+    // written as soon as it is accepted.
+    if (is_root || cost == best_plan_cost || best_plan_cost == -1
+        || cost <= refound_cost) {
+        Plan plan;
+        StateSequence state_seq;
+        materialize_plan(node.id, plan, state_seq);
+        if (is_root) {
+            root_plan_cost = calculate_plan_cost(plan);
+            cost = root_plan_cost;
+        }
+        assert(cost == calculate_plan_cost(plan));
+        assert(!skip_reorderings || compute_fingerprint(plan) == fingerprint);
+        last_plan_cost = cost;
+        check_set_best_plan(cost);
+        bool kept = keep_plan(plan, cost);
+        if (kept && skip_reorderings)
+            accept_plan(checked_plan, fingerprint, cost);
+        return kept;
     }
+    last_plan_cost = cost;
+    check_set_best_plan(cost);
+    // Distinct nodes of the path graph induce distinct plans
+    lazy_plans.push_back({node.id, cost});
+    number_of_kept_plans++;
+    if (skip_reorderings)
+        accept_plan(checked_plan, fingerprint, cost);
+    PendingPlan pending;
+    compute_sidetrack_seq(node.id, pending.sidetracks);
+    pending.cost = cost;
+    pending.materialized = false;
+    plan_writer->push(move(pending));
+    return true;
+}
 
-    Plan plan;
-    StateSequence state_seq;
+void PlanReconstructor::materialize_plan(NodeID node,
+                                         Plan &plan,
+                                         StateSequence &state_seq) const {
+    vector<Sap> seq;
+    compute_sidetrack_seq(node, seq);
     extract_plan(seq, plan, state_seq);
     plan.shrink_to_fit();
     plan.pop_back();
+}
 
-    if (!simple_plans_only || is_simple_plan(state_seq, state_registry)) {
-        if (!is_duplicate(plan)) {
-            last_plan_cost = calculate_plan_cost(plan);
-            check_set_best_plan(last_plan_cost);
-            return keep_plan(plan, last_plan_cost);
-        }
-    }
-    return false;
+int PlanReconstructor::get_num_workers(bool consumer_changes_registry) const {
+    // Checking plans and dumping them add states to the registry, which
+    // the workers read
+    if (num_threads == 1 || consumer_changes_registry || dump_plans
+        || verbosity >= Verbosity::NORMAL)
+        return 0;
+    return num_threads - 1;
+}
+
+void PlanReconstructor::for_each_lazy_plan(
+    const function<void(const LazyPlan &, const Plan &)> &consume,
+    bool consumer_changes_registry) const {
+    int num_workers = get_num_workers(consumer_changes_registry);
+    OrderedWorkerPool<pair<size_t, Plan>> pool(
+        num_workers, 256 * num_threads,
+        [this](pair<size_t, Plan> &item) {
+            StateSequence state_seq;
+            item.second.clear();
+            materialize_plan(lazy_plans[item.first].node, item.second, state_seq);
+        },
+        [this, &consume](pair<size_t, Plan> &item) {
+            consume(lazy_plans[item.first], item.second);
+        });
+    for (size_t i = 0; i < lazy_plans.size(); ++i)
+        pool.push({i, Plan()});
+    pool.flush();
+}
+
+void PlanReconstructor::materialize_plans() {
+    if (lazy_plans.empty())
+        return;
+    for_each_lazy_plan(
+        [this](const LazyPlan &lazy_plan, const Plan &plan) {
+            kept_plans[lazy_plan.cost].insert(plan);
+        }, false);
+    vector<LazyPlan>().swap(lazy_plans);
 }
 
 void PlanReconstructor::add_plan_explicit_no_check(Plan plan) {
@@ -200,6 +319,11 @@ void PlanReconstructor::add_plan_explicit_no_check(Plan plan) {
     last_plan_cost = calculate_plan_cost(plan);
     check_set_best_plan(last_plan_cost);
     keep_plan(plan, last_plan_cost);
+    flush_plans();
+}
+
+void PlanReconstructor::flush_plans() {
+    plan_writer->flush();
 }
 
 bool PlanReconstructor::keep_plan(const Plan& plan, int cost) {
@@ -212,42 +336,121 @@ bool PlanReconstructor::keep_plan(const Plan& plan, int cost) {
         plans_for_cost.insert(plan);
         kept_plans.insert({cost, plans_for_cost});
         number_of_kept_plans++;
-        // Only if the plan is optimal, we dump and save
-        if (cost == best_plan_cost) {
-            if (dump_plans) {
-                output_plan(plan, cost);
-                dump_dot_plan(plan);
-            }
-            save_plan(plan, true);
-        }
+        plan_writer->push({{}, plan, cost, true});
         return true;
     } 
     auto p = it->second.insert(plan);
     if (p.second) {
         number_of_kept_plans++;
-        if (cost == best_plan_cost) {
-            if (dump_plans) {
-                output_plan(plan, cost);
-                dump_dot_plan(plan);
-            }
-            save_plan(plan, true);
-        }
+        plan_writer->push({{}, plan, cost, true});
     }
     return p.second;
 }
 
-void PlanReconstructor::write_non_optimal_plans() {
-    for (auto& plans : kept_plans) {
-        if (plans.first == best_plan_cost) 
-            continue;
-        for (auto& plan : plans.second) {    
-            if (dump_plans) {
-                output_plan(plan, plans.first);
-                dump_dot_plan(plan);
-            }
-            save_plan(plan, true);
+void PlanReconstructor::write_plan(const Plan &plan, int cost) {
+    if (dump_plans) {
+        output_plan(plan, cost);
+        dump_dot_plan(plan);
+    }
+    plan_sink->write_plan(plan, cost);
+}
+
+// An entry of accepted_plans as it is written to a checkpoint
+struct AcceptedPlanRecord {
+    uint64_t sum;
+    int length;
+    int cost;
+    uint64_t start;
+};
+
+/*
+  The position of the plan sink, the number of plans written, the plan
+  counters, the kept plans as one block of [cost, length, operator
+  indices] records, the lazy plans and the accepted plans. The plans are
+  not written again when the search is resumed, since it goes on where
+  it stopped. Needs all plans to be written (see flush_plans).
+*/
+void PlanReconstructor::write_checkpoint(ostream &out) const {
+    write_value(out, plan_sink->get_position());
+    write_value(out, g_num_previously_generated_plans);
+    write_value(out, attempted_plans);
+    write_value(out, last_plan_cost);
+    write_value(out, best_plan_cost);
+    write_value(out, root_plan_cost);
+    write_value(out, number_of_kept_plans);
+    write_value(out, refound_cost);
+
+    vector<int32_t> kept;
+    for (const auto &plans_for_cost : kept_plans) {
+        for (const Plan &plan : plans_for_cost.second) {
+            kept.push_back(plans_for_cost.first);
+            kept.push_back(plan.size());
+            for (const GlobalOperator *op : plan)
+                kept.push_back(op->get_index());
         }
     }
+    write_vector(out, kept);
+    write_vector(out, lazy_plans);
+
+    vector<AcceptedPlanRecord> accepted;
+    accepted.reserve(accepted_plans.size());
+    for (const auto &entry : accepted_plans)
+        accepted.push_back({entry.first.sum, entry.first.length,
+                            entry.second.cost, entry.second.start});
+    write_vector(out, accepted);
+    write_vector(out, accepted_operators);
+}
+
+bool PlanReconstructor::read_checkpoint(istream &in) {
+    int64_t sink_position;
+    vector<int32_t> kept;
+    vector<AcceptedPlanRecord> accepted;
+    if (!read_value(in, sink_position) ||
+        !read_value(in, g_num_previously_generated_plans) ||
+        !read_value(in, attempted_plans) ||
+        !read_value(in, last_plan_cost) ||
+        !read_value(in, best_plan_cost) ||
+        !read_value(in, root_plan_cost) ||
+        !read_value(in, number_of_kept_plans) ||
+        !read_value(in, refound_cost) ||
+        !read_vector(in, kept) ||
+        !read_vector(in, lazy_plans) ||
+        !read_vector(in, accepted) ||
+        !read_vector(in, accepted_operators))
+        return false;
+
+    int num_operators = g_operators.size();
+    kept_plans.clear();
+    Plan plan;
+    for (size_t i = 0; i < kept.size();) {
+        if (kept.size() - i < 2 || kept[i + 1] < 0 ||
+            kept.size() - i - 2 < static_cast<size_t>(kept[i + 1]))
+            return false;
+        int cost = kept[i];
+        plan.resize(kept[i + 1]);
+        i += 2;
+        for (const GlobalOperator *&op : plan) {
+            if (kept[i] < 0 || kept[i] >= num_operators)
+                return false;
+            op = &g_operators[kept[i++]];
+        }
+        kept_plans[cost].insert(plan);
+    }
+    for (const LazyPlan &lazy_plan : lazy_plans) {
+        if (lazy_plan.node < 0 ||
+            lazy_plan.node >= static_cast<NodeID>(path_graph.size()))
+            return false;
+    }
+    accepted_plans.clear();
+    for (const AcceptedPlanRecord &record : accepted) {
+        if (record.length < 0 ||
+            record.start + record.length > accepted_operators.size())
+            return false;
+        accepted_plans.insert({{record.sum, record.length},
+                               {record.cost, record.start}});
+    }
+    plan_sink->resume_at(sink_position);
+    return true;
 }
 
 
@@ -255,17 +458,72 @@ int PlanReconstructor::get_last_added_plan_cost() const {
     return last_plan_cost;
 }
 
-bool PlanReconstructor::is_duplicate(const Plan& plan) {
-    if (!skip_reorderings)
+// Walk the plan of node like extract_plan does and collect its operators
+// in reverse order, without the states and checks of extract_plan
+void PlanReconstructor::collect_operators(NodeID node, Plan &operators) const {
+    vector<Sap> seq;
+    compute_sidetrack_seq(node, seq);
+    int seq_index = 0;
+    int seq_size = seq.size();
+
+    operators.clear();
+    GlobalState current_state = state_registry->lookup_state(goal_state);
+    for (;;) {
+        const SearchNodeInfo &info = search_space->get_node_info(current_state);
+        if (info.creating_operator == -1 && seq_index == seq_size)
+            break;
+        if (seq_index < seq_size
+            && saps[seq[seq_index]].to == current_state.get_id()) {
+            operators.push_back(saps.get_op(seq[seq_index]));
+            current_state = saps.get_from_state(seq[seq_index]);
+            ++seq_index;
+        } else {
+            operators.push_back(&g_operators[info.creating_operator]);
+            current_state = state_registry->lookup_state(info.parent_state_id);
+        }
+    }
+    // The first operator is the goal operator, which is not part of the plan
+    operators.erase(operators.begin());
+}
+
+PlanReconstructor::Fingerprint PlanReconstructor::compute_fingerprint(
+    const Plan &plan) const {
+    Fingerprint fingerprint = {0, static_cast<int>(plan.size())};
+    for (const GlobalOperator *op : plan)
+        fingerprint.sum += operator_keys[op->get_index()];
+    return fingerprint;
+}
+
+void PlanReconstructor::sort_operators(const Plan &plan,
+                                       vector<int> &operators) const {
+    operators.clear();
+    for (const GlobalOperator *op : plan)
+        operators.push_back(op->get_index());
+    sort(operators.begin(), operators.end());
+}
+
+// Check whether plan is a reordering of an accepted plan. Plans are only
+// compared in full if their fingerprints are equal.
+bool PlanReconstructor::is_duplicate(const Plan &plan,
+                                     const Fingerprint &fingerprint) {
+    auto range = accepted_plans.equal_range(fingerprint);
+    if (range.first == range.second)
         return false;
-    
-    // Checks whether the plan is a duplicate of an existing plan, and if not, add it to existing plans
+    sort_operators(plan, checked_operators);
+    for (auto it = range.first; it != range.second; ++it) {
+        auto accepted = accepted_operators.begin() + it->second.start;
+        if (equal(checked_operators.begin(), checked_operators.end(), accepted))
+            return true;
+    }
+    return false;
+}
 
-    // Each plan is kept as a sorted vector by operator ids
-    Plan unordered_plan = plan;
-    std::sort(unordered_plan.begin(), unordered_plan.end());
-	std::pair<PlansSet::iterator, bool > result = accepted_plans.insert(unordered_plan);
-    return !result.second;
+void PlanReconstructor::accept_plan(const Plan &plan,
+                                    const Fingerprint &fingerprint, int cost) {
+    accepted_plans.insert({fingerprint, {cost, accepted_operators.size()}});
+    sort_operators(plan, checked_operators);
+    accepted_operators.insert(accepted_operators.end(),
+                              checked_operators.begin(), checked_operators.end());
 }
 
 void PlanReconstructor::dump_dot_plan(const Plan& plan) {
@@ -380,7 +638,8 @@ void PlanReconstructor::dump_action_json(const GlobalOperator *op, std::ostream&
     std::vector<std::string> parsed;
     action_name_parsing(op->get_name(), parsed);
 
-    os << "{ \"name\" : " << "\"" << parsed[0] << "\"" ;
+    os << "{ \"name\" : ";
+    utils::write_json_string(os, parsed[0]);
     os << ", ";
     os << "\"params\" : [";
     bool first = true;
@@ -389,7 +648,7 @@ void PlanReconstructor::dump_action_json(const GlobalOperator *op, std::ostream&
             os << ", ";
         }
         first = false;
-        os << "\"" << parsed[i] << "\"";
+        utils::write_json_string(os, parsed[i]);
     }
     os << "]}";
 }
@@ -441,7 +700,7 @@ void PlanReconstructor::dump_state_json(const StateID& state, std::ostream& os)
             os << ", ";
         }
         first = false;
-        os << "\"" << state_parsed[i] << "\"";
+        utils::write_json_string(os, state_parsed[i]);
     }
     os << "]";
 }
@@ -458,17 +717,53 @@ void PlanReconstructor::output_plan(const Plan& plan, int cost) {
 }
 
 void PlanReconstructor::dump_plans_json(std::ostream& os, bool dump_states) const {
+    vector<const Plan *> plans;
+    for (auto& plans_for_cost : kept_plans) {
+        for (auto& plan : plans_for_cost.second)
+            plans.push_back(&plan);
+    }
+    size_t num_plans = plans.size() + lazy_plans.size();
+
+    // Plans are rendered by the workers, unless the states are dumped
+    int num_workers = get_num_workers(dump_states);
+    OrderedWorkerPool<pair<size_t, string>> pool(
+        num_workers, 256 * num_threads,
+        [this, &plans, dump_states](pair<size_t, string> &item) {
+            size_t i = item.first;
+            ostringstream plan_os;
+            if (i < plans.size()) {
+                dump_plan_json(*plans[i], plan_os, dump_states);
+            } else {
+                Plan plan;
+                StateSequence state_seq;
+                materialize_plan(lazy_plans[i - plans.size()].node, plan, state_seq);
+                dump_plan_json(plan, plan_os, dump_states);
+            }
+            item.second = plan_os.str();
+        },
+        [&os](pair<size_t, string> &item) {
+            if (item.first > 0)
+                os << "," << endl;
+            os << item.second;
+        });
     os << "{ \"plans\" : [" << endl;
-    bool first_dumped = false;
+    for (size_t i = 0; i < num_plans; ++i)
+        pool.push({i, string()});
+    pool.flush();
+    os << "]}" << endl;
+}
+
+void PlanReconstructor::dump_plan_set(const std::string &filename, bool dump_states) const {
+    PlanSetWriter writer(filename, *state_registry, *search_space, dump_states);
     for (auto& plans : kept_plans) {
-        for (auto& plan : plans.second) {    
-            if (first_dumped)
-                    os << "," << endl;
-                dump_plan_json(plan, os, dump_states);
-                first_dumped = true;
-        }
+        for (auto& plan : plans.second)
+            writer.write_plan(plan, calculate_plan_cost(plan));
     }
-    os << "]}" << endl;
+    for_each_lazy_plan(
+        [&writer](const LazyPlan &, const Plan &plan) {
+            writer.write_plan(plan, calculate_plan_cost(plan));
+        }, dump_states);
+    writer.finish();
 }
 
 void PlanReconstructor::dump_plan_json(Plan plan, std::ostream& os, bool dump_states) const {
@@ -477,9 +772,10 @@ void PlanReconstructor::dump_plan_json(Plan plan, std::ostream& os, bool dump_st
     os << "\"cost\" : " << plan_cost << "," << endl; 
     os << "\"actions\" : [" << endl;
     if (plan.size() > 0) {
-        os << "\""  << plan[0]->get_name() << "\"";
+        utils::write_json_string(os, plan[0]->get_name());
         for (size_t i = 1; i < plan.size(); ++i) {
-            os << ", \"" << plan[i]->get_name() << "\"";
+            os << ", ";
+            utils::write_json_string(os, plan[i]->get_name());
         }
     }
     os << "]";
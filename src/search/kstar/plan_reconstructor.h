@@ -2,27 +2,103 @@
 #define KSTAR_PLAN_RECONSTRUCTOR_H
 
 #include "kstar_types.h"
+#include "ordered_worker_pool.h"
+#include "path_graph.h"
+#include "plan_sink.h"
+
+#include <functional>
+#include <unordered_map>
 
 namespace kstar {
 
+// Where the plan of a path graph node revisits a state, if it does
+enum class Revisit {
+    NONE,
+    // The plan of the node is not simple
+    NODE,
+    // The part of the plan shared by all descendants of the node is not
+    // simple, so no plan in its subtree is
+    SUBTREE
+};
+
 class PlanReconstructor {
-    std::unordered_map<Node, Node> &parent_node;
-    std::unordered_set<Edge> &cross_edge;
+    typedef std::unordered_set<Plan> PlansSet;
+    const SapArena &saps;
+    const PathGraph &path_graph;
     StateID goal_state;
     StateRegistry* state_registry;
     SearchSpace* search_space;
     const bool skip_reorderings;
     bool dump_plans;
+    std::unique_ptr<PlanSink> plan_sink;
+    // Threads that materialize, write and render lazy plans
+    const int num_threads;
     Verbosity verbosity;
-    typedef std::unordered_set<Plan> PlansSet;
 
-    // Keep plans (sorted vectors of operators) in a set
-    PlansSet accepted_plans;
+    // Order independent fingerprint of a plan: the sum of the random keys
+    // of its operators and its length. All reorderings of a plan share
+    // its fingerprint, so plans only need to be compared when their
+    // fingerprints are equal.
+    struct Fingerprint {
+        uint64_t sum;
+        int length;
+        bool operator==(const Fingerprint &other) const {
+            return sum == other.sum && length == other.length;
+        }
+    };
+    struct FingerprintHash {
+        size_t operator()(const Fingerprint &fingerprint) const {
+            return fingerprint.sum ^ (fingerprint.length * 0x9e3779b97f4a7c15ULL);
+        }
+    };
+    // A plan accepted with skip_reorderings: its cost and the position of
+    // its sorted operator indices in accepted_operators
+    struct AcceptedPlan {
+        int cost;
+        size_t start;
+    };
+    std::vector<uint64_t> operator_keys;
+    std::unordered_multimap<Fingerprint, AcceptedPlan, FingerprintHash> accepted_plans;
+    std::vector<int> accepted_operators;
+    // Operators of the plan checked by is_duplicate, in reverse order,
+    // and their sorted indices
+    Plan checked_plan;
+    std::vector<int> checked_operators;
     int attempted_plans;
     int last_plan_cost;
     int best_plan_cost;
     std::unordered_map<int, PlansSet> kept_plans; // Plans kept in a set by cost
+    // Non-optimal plans found by the current Dijkstra search that were not
+    // materialized yet. Such a plan is given by the path graph node whose
+    // sidetrack sequence induces it, which is only meaningful as long as
+    // the shortest path tree does not change.
+    struct LazyPlan {
+        NodeID node;
+        int cost;
+    };
+    std::vector<LazyPlan> lazy_plans;
+    // Cost of the plan induced by the root of the path graph
+    int root_plan_cost;
     int number_of_kept_plans;
+    // The plans up to this cost may have been found before the Dijkstra
+    // search restarted. They are all kept in kept_plans.
+    int refound_cost;
+    // Check in which each state was last seen by find_revisit, so that
+    // checking a plan does not need a fresh table
+    PerStateInformation<int> seen_in_check;
+    int simple_plan_checks;
+    // A plan to write, given either in full or by the sidetrack sequence
+    // of a lazy plan
+    struct PendingPlan {
+        std::vector<Sap> sidetracks;
+        Plan plan;
+        int cost;
+        bool materialized;
+    };
+    // Writes the plans in the order in which they are accepted. Lazy
+    // plans are materialized by its workers while the Dijkstra search
+    // goes on.
+    std::unique_ptr<OrderedWorkerPool<PendingPlan>> plan_writer;
 
     std::string fact_to_pddl(std::string fact) const;
     std::string restructure_fact(std::string fact) const;
@@ -30,7 +106,10 @@ class PlanReconstructor {
     void dump_action_json(const GlobalOperator *op, std::ostream& os);
     void dump_state_json(const StateID& state, std::ostream& os);
     void action_name_parsing(std::string op_name, std::vector<std::string>& parsed);
-    bool is_duplicate(const Plan& plan);
+    Fingerprint compute_fingerprint(const Plan &plan) const;
+    void sort_operators(const Plan &plan, std::vector<int> &operators) const;
+    bool is_duplicate(const Plan &plan, const Fingerprint &fingerprint);
+    void accept_plan(const Plan &plan, const Fingerprint &fingerprint, int cost);
 
     size_t get_hash_value(const Plan &plan) const {
         std::size_t seed = plan.size();
@@ -41,37 +120,69 @@ class PlanReconstructor {
     }
 
     bool keep_plan(const Plan& plan, int cost);
+    void materialize_plan(NodeID node, Plan &plan, StateSequence &state_seq) const;
+    // Workers read the path graph, the shortest path tree and the states
+    // through const lookups only, which do not resize any table
+    int get_num_workers(bool consumer_changes_registry) const;
+    // Materialize the lazy plans on worker threads and pass them to
+    // consume in order. consume runs on the calling thread and may only
+    // add states if consumer_changes_registry is set.
+    void for_each_lazy_plan(
+        const std::function<void(const LazyPlan &, const Plan &)> &consume,
+        bool consumer_changes_registry) const;
     void output_plan(const Plan& plan, int cost);
+    void write_plan(const Plan &plan, int cost);
     void dump_plan_json(Plan plan, std::ostream& os, bool dump_states) const;
     void check_set_best_plan(int cost);
 
 public:
-    PlanReconstructor(std::unordered_map<Node, Node>& parent_sap,
-                       std::unordered_set<Edge>& cross_edge,
+    PlanReconstructor(const SapArena &saps,
+                       const PathGraph &path_graph,
                        StateID goal_state,
                        StateRegistry* state_registry,
                        SearchSpace* search_space,
                        bool skip_reorderings,
                        bool dump_plans,
+                       std::unique_ptr<PlanSink> plan_sink,
+                       int num_threads,
                        Verbosity verbosity);
 
     virtual ~PlanReconstructor() = default;
-    std::vector<Node> djkstra_traceback(Node node);
-    std::vector<Node> compute_sidetrack_seq(std::vector<Node>& path);
-    void extract_plan(vector<Node>& seq, Plan &plan, StateSequence &state_seq);
-    bool is_simple_plan(StateSequence seq, StateRegistry* state_registry);
+    void compute_sidetrack_seq(NodeID node, std::vector<Sap> &seq) const;
+    void extract_plan(vector<Sap>& seq, Plan &plan, StateSequence &state_seq) const;
+    // Operators of the plan of node in reverse order, without building
+    // its state sequence
+    void collect_operators(NodeID node, Plan &operators) const;
+    Revisit find_revisit(NodeID node);
     void set_goal_state(StateID goal_state);
-    bool add_plan(Node node, bool simple_plans_only);
+    // Needed for the costs of the other plans if the plan of the root
+    // of the path graph is not added
+    void set_root_plan_cost(int cost) {root_plan_cost = cost; }
+    bool add_plan(Node node);
     void dump_dot_plan(const Plan& plan);
+    // Run before the Dijkstra search restarts on a new path graph
     void clear();
+    // Forget all plans, including the optimal and the written ones, e.g.
+    // because the operator costs changed
+    void reset();
     int get_last_added_plan_cost() const;
     void add_plan_explicit_no_check(Plan plan);
+    // Wait until all accepted plans are written. Run before A* changes
+    // the search space that the workers of plan_writer read.
+    void flush_plans();
 
     void dump_plans_json(std::ostream& os, bool dump_states) const;
+    // Write the plans in the order of dump_plans_json to a plan set file
+    void dump_plan_set(const std::string &filename, bool dump_states) const;
     size_t number_of_plans_found() const {return number_of_kept_plans; }
 
-    // Run at the end of the successful Dijkstra iteration
-    void write_non_optimal_plans();
+    // Save the plans found so far and the position of the plan sink with
+    // a checkpoint of the search, and restore both when the search is
+    // resumed. The path graph has to be restored first.
+    void write_checkpoint(std::ostream &out) const;
+    bool read_checkpoint(std::istream &in);
+    // Run before the shortest path tree may change
+    void materialize_plans();
 
 };
 }
@@ -0,0 +1,127 @@
+#include "plan_sampling.h"
+
+#include "kstar.h"
+
+#include "../option_parser.h"
+#include "../plugin.h"
+
+#include "../utils/rng.h"
+#include "../utils/rng_options.h"
+#include "../utils/system.h"
+
+using namespace std;
+
+namespace kstar {
+PlanSampling::PlanSampling(const options::Options &opts)
+    : PathSpaceSearch(opts),
+      num_samples(opts.get<int>("num_samples")),
+      distribution(static_cast<SampleDistribution>(opts.get_enum("distribution"))),
+      simple_plans_only(opts.get<bool>("simple_plans_only")),
+      max_rejections(opts.get<int>("max_rejections")),
+      rng(utils::parse_rng_from_options(opts)),
+      plan_sink(create_plan_sink(opts)) {
+}
+
+int PlanSampling::choose_cost(const vector<PathSpace::Count> &histogram) {
+    if (distribution == SampleDistribution::UNIFORM)
+        return PathSpace::choose_weighted(histogram, *rng);
+    vector<int> costs;
+    for (size_t cost = 0; cost < histogram.size(); ++cost) {
+        if (histogram[cost] > 0)
+            costs.push_back(cost);
+    }
+    return *rng->choose(costs);
+}
+
+void PlanSampling::analyze(const PathSpace &path_space) {
+    if (path_space.has_infinitely_many_plans()) {
+        cerr << "Cannot sample plans: a zero-cost cycle lies on plans of "
+             << "cost at most " << path_space.get_bound() << endl;
+        utils::exit_with(utils::ExitCode::UNSUPPORTED);
+    }
+    vector<PathSpace::Count> histogram(path_space.get_bound() + 1, 0);
+    PathSpace::Count total = 0;
+    for (int cost = 0; cost <= path_space.get_bound(); ++cost) {
+        histogram[cost] = path_space.count_plans(cost);
+        total = PathSpace::add_counts(total, histogram[cost]);
+    }
+    if (total == PathSpace::MAX_COUNT)
+        cout << "Too many plans to count exactly, samples are only close "
+             << "to uniform" << endl;
+    // Only plans that revisit states are rejected
+    bool reject = simple_plans_only && path_space.has_cycles();
+
+    int rejections = 0;
+    Plan plan;
+    for (int sample = 0; sample < num_samples; ++sample) {
+        int cost = choose_cost(histogram);
+        if (!path_space.sample_plan(cost, *rng, reject, plan)) {
+            if (++rejections > max_rejections) {
+                cout << "Too many plans revisit states, giving up after "
+                     << sample << " samples" << endl;
+                break;
+            }
+            --sample;
+            continue;
+        }
+        plan_sink->write_plan(plan, cost);
+    }
+    cout << "Plans of cost at most " << path_space.get_bound() << ": "
+         << total << endl;
+    if (reject)
+        cout << "Rejected samples: " << rejections << endl;
+}
+
+static SearchEngine *_parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Plan sampling",
+        "Draws plans of cost at most q times the optimal cost at random, "
+        "from the plans that kstar finds with the same q. A plan is drawn "
+        "by a random walk backwards from the goal, guided by the numbers "
+        "of plans that kstar_count computes. The time for each sample is "
+        "linear in the length of the plan, so it does not depend on the "
+        "number of plans. Plans are drawn with replacement. "
+        "With simple_plans_only, plans that revisit a state are rejected "
+        "and drawn again.");
+    add_path_space_search_options(parser);
+    parser.add_option<int>(
+        "num_samples",
+        "number of plans to draw",
+        "100",
+        Bounds("0", "infinity"));
+    vector<string> distributions;
+    vector<string> distribution_docs;
+    distributions.push_back("uniform");
+    distribution_docs.push_back(
+        "uniform: every plan is equally likely");
+    distributions.push_back("uniform_cost");
+    distribution_docs.push_back(
+        "uniform_cost: every cost that plans have is equally likely, and "
+        "every plan of the cost drawn");
+    parser.add_enum_option(
+        "distribution",
+        distributions,
+        "Distribution of the plans drawn.",
+        "uniform",
+        distribution_docs);
+    add_simple_plans_only_option(parser);
+    parser.add_option<int>(
+        "max_rejections",
+        "Stop after this many plans that revisit a state were drawn "
+        "with simple_plans_only",
+        "100000",
+        Bounds("0", "infinity"));
+    add_plan_sink_options(parser);
+    utils::add_rng_options(parser);
+    Options opts = parser.parse();
+
+    PlanSampling *engine = nullptr;
+    if (!parser.dry_run()) {
+        set_path_space_search_options(opts);
+        engine = new PlanSampling(opts);
+    }
+    return engine;
+}
+
+static Plugin<SearchEngine> _plugin("kstar_sample", _parse);
+}
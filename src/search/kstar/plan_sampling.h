@@ -0,0 +1,38 @@
+#ifndef KSTAR_PLAN_SAMPLING_H
+#define KSTAR_PLAN_SAMPLING_H
+
+#include "path_space.h"
+#include "path_space_search.h"
+#include "plan_sink.h"
+
+#include <memory>
+
+namespace utils {
+class RandomNumberGenerator;
+}
+
+namespace kstar {
+enum class SampleDistribution {
+    UNIFORM,
+    UNIFORM_COST
+};
+
+// Draw plans of cost at most q times the optimal cost at random
+class PlanSampling : public PathSpaceSearch {
+    const int num_samples;
+    const SampleDistribution distribution;
+    const bool simple_plans_only;
+    const int max_rejections;
+    std::shared_ptr<utils::RandomNumberGenerator> rng;
+    std::unique_ptr<PlanSink> plan_sink;
+
+    int choose_cost(const std::vector<PathSpace::Count> &histogram);
+protected:
+    virtual void analyze(const PathSpace &path_space) override;
+public:
+    explicit PlanSampling(const options::Options &opts);
+    virtual ~PlanSampling() = default;
+};
+}
+
+#endif
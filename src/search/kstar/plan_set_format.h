@@ -0,0 +1,78 @@
+#ifndef KSTAR_PLAN_SET_FORMAT_H
+#define KSTAR_PLAN_SET_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+  Binary plan set format, written by PlanSetWriter and read by
+  PlanSetReader. It is laid out to be memory-mapped: all fixed-width
+  fields are in native byte order and 8-byte aligned, and plans are
+  found by number through an offset index.
+
+    header          PlanSetHeader
+    operator table  string table with num_operators names
+    fact table      string table with num_facts names
+    plans           plan records
+    plan index      num_plans + 1 uint64 file offsets; plan i is stored
+                    between the offsets i and i + 1
+
+  A string table is count + 1 uint64 offsets followed by the characters
+  of all strings; string i lies between the offsets i and i + 1, relative
+  to the start of the characters. Tables are padded to 8 bytes. The
+  index comes last so that plans can be written as they are produced.
+
+  A plan record is a sequence of varints (7 bits per byte, least
+  significant group first): the cost, the number of operators and their
+  indices into the operator table. If the header has FLAG_STATES, the
+  plan is followed by its number of operators + 1 states, starting with
+  the initial state. A state is its number of facts followed by its
+  fact indices into the fact table, in increasing order and stored as
+  differences to the previous index.
+
+  The fact table only holds the facts that SearchSpace::dump_state
+  prints, so a state is exactly what dump_plans_json shows for it.
+*/
+namespace plan_set {
+const uint32_t MAGIC = 0x4b505354;
+const uint32_t VERSION = 1;
+const uint32_t FLAG_STATES = 1;
+
+struct PlanSetHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t flags;
+    uint32_t padding;
+    uint64_t num_operators;
+    uint64_t num_facts;
+    uint64_t num_plans;
+    uint64_t operator_table;
+    uint64_t fact_table;
+    uint64_t plan_index;
+};
+
+inline void append_varint(std::string &buffer, uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+}
+
+// Decode the varint at pos and advance pos past it. Return false if the
+// varint does not end before end.
+inline bool read_varint(const unsigned char *&pos, const unsigned char *end,
+                        uint64_t &value) {
+    value = 0;
+    for (int shift = 0; pos != end && shift < 64; shift += 7) {
+        unsigned char byte = *pos++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+}
+
+#endif
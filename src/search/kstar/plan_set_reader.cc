@@ -0,0 +1,214 @@
+#include "plan_set_reader.h"
+
+#include "../utils/json.h"
+#include "../utils/system.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#if OPERATING_SYSTEM != WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace plan_set {
+PlanSetReader::PlanSetReader()
+    : data(nullptr),
+      size(0),
+      header() {
+}
+
+PlanSetReader::~PlanSetReader() {
+    close();
+}
+
+void PlanSetReader::close() {
+#if OPERATING_SYSTEM != WINDOWS
+    if (data && buffer.empty())
+        munmap(const_cast<unsigned char *>(data), size);
+#endif
+    buffer.clear();
+    data = nullptr;
+    size = 0;
+    header = PlanSetHeader();
+}
+
+bool PlanSetReader::fail(const string &message) {
+    close();
+    error = message;
+    return false;
+}
+
+bool PlanSetReader::open(const string &filename) {
+    close();
+#if OPERATING_SYSTEM == WINDOWS
+    ifstream in(filename, ios_base::in | ios_base::binary);
+    if (!in)
+        return fail("could not open " + filename);
+    buffer.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        return fail("could not open " + filename);
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1 || file_stat.st_size == 0) {
+        ::close(fd);
+        return fail(filename + " is empty or cannot be read");
+    }
+    void *mapping = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return fail("could not map " + filename);
+    data = static_cast<const unsigned char *>(mapping);
+    size = file_stat.st_size;
+#endif
+
+    if (size < sizeof(header))
+        return fail("file too short for a plan set header");
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != MAGIC)
+        return fail("not a plan set file");
+    if (header.version != VERSION)
+        return fail("unsupported plan set version " + to_string(header.version));
+    if (!check_string_table(header.operator_table, header.num_operators) ||
+        !check_string_table(header.fact_table, header.num_facts))
+        return false;
+    if (header.plan_index % 8 != 0 || header.plan_index > size ||
+        header.num_plans >= size ||
+        (size - header.plan_index) / sizeof(uint64_t) < header.num_plans + 1)
+        return fail("plan index out of bounds");
+    for (size_t i = 0; i < header.num_plans; ++i) {
+        if (get_plan_offset(i) > get_plan_offset(i + 1))
+            return fail("plan index not sorted");
+    }
+    if (get_plan_offset(header.num_plans) > header.plan_index)
+        return fail("plans overlap the plan index");
+    return true;
+}
+
+bool PlanSetReader::check_string_table(uint64_t table, uint64_t count) {
+    if (table % 8 != 0 || table > size || count >= size ||
+        (size - table) / sizeof(uint64_t) < count + 1)
+        return fail("string table out of bounds");
+    const uint64_t *offsets = reinterpret_cast<const uint64_t *>(data + table);
+    for (size_t i = 0; i < count; ++i) {
+        if (offsets[i] > offsets[i + 1])
+            return fail("string table not sorted");
+    }
+    uint64_t chars = table + (count + 1) * sizeof(uint64_t);
+    if (offsets[count] > size - chars)
+        return fail("string table out of bounds");
+    return true;
+}
+
+string PlanSetReader::get_string(uint64_t table, uint64_t count, size_t index) const {
+    const uint64_t *offsets = reinterpret_cast<const uint64_t *>(data + table);
+    const char *chars = reinterpret_cast<const char *>(offsets + count + 1);
+    return string(chars + offsets[index], chars + offsets[index + 1]);
+}
+
+string PlanSetReader::get_operator_name(size_t index) const {
+    return get_string(header.operator_table, header.num_operators, index);
+}
+
+string PlanSetReader::get_fact_name(size_t index) const {
+    return get_string(header.fact_table, header.num_facts, index);
+}
+
+uint64_t PlanSetReader::get_plan_offset(size_t index) const {
+    return reinterpret_cast<const uint64_t *>(data + header.plan_index)[index];
+}
+
+bool PlanSetReader::read_plan(size_t index, PlanRecord &plan) {
+    const unsigned char *pos = data + get_plan_offset(index);
+    const unsigned char *end = data + get_plan_offset(index + 1);
+    string corrupt = "plan " + to_string(index) + " is corrupt";
+    uint64_t cost;
+    uint64_t length;
+    if (!read_varint(pos, end, cost) || !read_varint(pos, end, length) ||
+        length > static_cast<uint64_t>(end - pos)) {
+        error = corrupt;
+        return false;
+    }
+    plan.cost = cost;
+    plan.operators.resize(length);
+    for (int &op : plan.operators) {
+        uint64_t value;
+        if (!read_varint(pos, end, value) || value >= header.num_operators) {
+            error = corrupt;
+            return false;
+        }
+        op = value;
+    }
+    plan.states.clear();
+    if (has_states()) {
+        plan.states.resize(length + 1);
+        for (vector<int> &state : plan.states) {
+            uint64_t num_facts;
+            if (!read_varint(pos, end, num_facts) ||
+                num_facts > static_cast<uint64_t>(end - pos)) {
+                error = corrupt;
+                return false;
+            }
+            state.resize(num_facts);
+            uint64_t fact = 0;
+            for (int &value : state) {
+                uint64_t delta;
+                if (!read_varint(pos, end, delta) ||
+                    delta >= header.num_facts - fact) {
+                    error = corrupt;
+                    return false;
+                }
+                fact += delta;
+                value = fact;
+            }
+        }
+    }
+    return true;
+}
+
+// Same output as SearchSpace::dump_state
+static void dump_state(const PlanSetReader &reader, const vector<int> &state,
+                       ostream &os) {
+    os << "[" << endl;
+    for (size_t i = 0; i < state.size(); ++i) {
+        utils::write_json_string(os, reader.get_fact_name(state[i]));
+        if (i + 1 < state.size())
+            os << ",";
+        os << endl;
+    }
+    os << "]" << endl;
+}
+
+void dump_plan_json(const PlanSetReader &reader, const PlanRecord &plan,
+                    ostream &os) {
+    os << "{ ";
+    os << "\"cost\" : " << plan.cost << "," << endl;
+    os << "\"actions\" : [" << endl;
+    for (size_t i = 0; i < plan.operators.size(); ++i) {
+        if (i > 0)
+            os << ", ";
+        utils::write_json_string(os, reader.get_operator_name(plan.operators[i]));
+    }
+    os << "]";
+    if (reader.has_states()) {
+        os << "," << endl;
+        os << "\"states\" : [" << endl;
+        for (size_t i = 0; i < plan.states.size(); ++i) {
+            if (i > 0)
+                os << "," << endl;
+            dump_state(reader, plan.states[i], os);
+        }
+        os << "]";
+    }
+    os << "}" << endl;
+}
+}
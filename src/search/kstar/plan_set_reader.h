@@ -0,0 +1,78 @@
+#ifndef KSTAR_PLAN_SET_READER_H
+#define KSTAR_PLAN_SET_READER_H
+
+#include "plan_set_format.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/*
+  Reads plan set files (see plan_set_format.h). The reader does not
+  depend on the rest of the planner, so that tools can be built from it
+  alone (see plan_set_to_json.cc).
+*/
+namespace plan_set {
+struct PlanRecord {
+    int cost;
+    std::vector<int> operators;
+    // Fact indices of each state along the plan, if the set has states
+    std::vector<std::vector<int>> states;
+};
+
+/*
+  Maps a plan set file into memory. Opening checks the header and the
+  tables; plans are only decoded (and checked) when they are read, so
+  opening is cheap and any plan can be read without reading the ones
+  before it.
+*/
+class PlanSetReader {
+    const unsigned char *data;
+    size_t size;
+    std::vector<unsigned char> buffer;
+    PlanSetHeader header;
+    std::string error;
+
+    void close();
+    bool fail(const std::string &message);
+    bool check_string_table(uint64_t table, uint64_t count);
+    std::string get_string(uint64_t table, uint64_t count, size_t index) const;
+    uint64_t get_plan_offset(size_t index) const;
+public:
+    PlanSetReader();
+    ~PlanSetReader();
+    PlanSetReader(const PlanSetReader &) = delete;
+    PlanSetReader &operator=(const PlanSetReader &) = delete;
+
+    // Return false and set the error message if the file is not a
+    // valid plan set
+    bool open(const std::string &filename);
+    const std::string &get_error() const {
+        return error;
+    }
+
+    size_t get_num_plans() const {
+        return header.num_plans;
+    }
+    size_t get_num_operators() const {
+        return header.num_operators;
+    }
+    size_t get_num_facts() const {
+        return header.num_facts;
+    }
+    bool has_states() const {
+        return header.flags & FLAG_STATES;
+    }
+    std::string get_operator_name(size_t index) const;
+    std::string get_fact_name(size_t index) const;
+
+    // Return false and set the error message if the record is corrupt
+    bool read_plan(size_t index, PlanRecord &plan);
+};
+
+// The plan in the format of PlanReconstructor::dump_plan_json
+void dump_plan_json(const PlanSetReader &reader, const PlanRecord &plan,
+                    std::ostream &os);
+}
+
+#endif
@@ -0,0 +1,56 @@
+#include "plan_set_reader.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+  Convert a plan set file written by K* (option plan_set_file_to_dump) to
+  the JSON format of its option json_file_to_dump. With plan numbers
+  (counted from 0), only these plans are converted.
+*/
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        cerr << "usage: " << argv[0] << " <plan set file> [<plan number> ...]"
+             << endl;
+        return 2;
+    }
+    plan_set::PlanSetReader reader;
+    if (!reader.open(argv[1])) {
+        cerr << argv[1] << ": " << reader.get_error() << endl;
+        return 1;
+    }
+
+    vector<size_t> plans;
+    for (int i = 2; i < argc; ++i) {
+        char *end;
+        unsigned long long number = strtoull(argv[i], &end, 10);
+        if (*end || end == argv[i] || number >= reader.get_num_plans()) {
+            cerr << "no plan " << argv[i] << " among "
+                 << reader.get_num_plans() << " plans" << endl;
+            return 2;
+        }
+        plans.push_back(number);
+    }
+    if (argc == 2) {
+        for (size_t i = 0; i < reader.get_num_plans(); ++i)
+            plans.push_back(i);
+    }
+
+    cout << "{ \"plans\" : [" << endl;
+    plan_set::PlanRecord plan;
+    for (size_t i = 0; i < plans.size(); ++i) {
+        if (!reader.read_plan(plans[i], plan)) {
+            cerr << argv[1] << ": " << reader.get_error() << endl;
+            return 1;
+        }
+        if (i > 0)
+            cout << "," << endl;
+        plan_set::dump_plan_json(reader, plan, cout);
+    }
+    cout << "]}" << endl;
+    return 0;
+}
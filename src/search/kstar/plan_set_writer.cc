@@ -0,0 +1,138 @@
+#include "plan_set_writer.h"
+
+#include "../global_operator.h"
+#include "../globals.h"
+#include "../search_space.h"
+#include "../state_registry.h"
+
+#include "../utils/system.h"
+
+#include <iostream>
+
+using namespace std;
+using utils::ExitCode;
+
+namespace kstar {
+// Facts that SearchSpace::dump_state leaves out
+static bool is_hidden_fact(const string &fact_name) {
+    return fact_name == "__special_value_false__" ||
+           fact_name == "__special_value_true__" ||
+           fact_name == "<none of those>" ||
+           fact_name.compare(0, 11, "NegatedAtom") == 0;
+}
+
+PlanSetWriter::PlanSetWriter(const string &filename,
+                             StateRegistry &state_registry,
+                             const SearchSpace &search_space,
+                             bool with_states)
+    : state_registry(state_registry),
+      search_space(search_space),
+      with_states(with_states),
+      header() {
+    out.open(filename, ios_base::out | ios_base::binary);
+    if (!out) {
+        cerr << "Could not open plan set file " << filename << endl;
+        utils::exit_with(ExitCode::CRITICAL_ERROR);
+    }
+    header.magic = plan_set::MAGIC;
+    header.version = plan_set::VERSION;
+    header.flags = with_states ? plan_set::FLAG_STATES : 0;
+    // Written again with the final counts by finish
+    write_raw(&header, sizeof(header));
+
+    vector<string> operator_names;
+    for (const GlobalOperator &op : g_operators)
+        operator_names.push_back(op.get_name());
+    header.num_operators = operator_names.size();
+    header.operator_table = out.tellp();
+    write_string_table(operator_names);
+
+    const AbstractTask &task = state_registry.get_task();
+    vector<string> fact_names;
+    fact_ids.resize(task.get_num_variables());
+    for (int var = 0; var < task.get_num_variables(); ++var) {
+        for (int val = 0; val < task.get_variable_domain_size(var); ++val) {
+            string fact_name = task.get_fact_name(FactPair(var, val));
+            if (is_hidden_fact(fact_name)) {
+                fact_ids[var].push_back(-1);
+            } else {
+                fact_ids[var].push_back(fact_names.size());
+                fact_names.push_back(fact_name);
+            }
+        }
+    }
+    header.num_facts = fact_names.size();
+    header.fact_table = out.tellp();
+    write_string_table(fact_names);
+}
+
+void PlanSetWriter::write_raw(const void *data, size_t size) {
+    out.write(static_cast<const char *>(data), size);
+}
+
+void PlanSetWriter::pad() {
+    static const char zeros[8] = {};
+    size_t misalignment = static_cast<uint64_t>(out.tellp()) % 8;
+    if (misalignment)
+        write_raw(zeros, 8 - misalignment);
+}
+
+void PlanSetWriter::write_string_table(const vector<string> &strings) {
+    uint64_t offset = 0;
+    write_raw(&offset, sizeof(offset));
+    for (const string &s : strings) {
+        offset += s.size();
+        write_raw(&offset, sizeof(offset));
+    }
+    for (const string &s : strings)
+        write_raw(s.data(), s.size());
+    pad();
+}
+
+void PlanSetWriter::append_state(const GlobalState &state) {
+    vector<int> facts;
+    for (size_t var = 0; var < fact_ids.size(); ++var) {
+        int fact = fact_ids[var][state[var]];
+        if (fact != -1)
+            facts.push_back(fact);
+    }
+    plan_set::append_varint(record, facts.size());
+    int previous = 0;
+    for (int fact : facts) {
+        plan_set::append_varint(record, fact - previous);
+        previous = fact;
+    }
+}
+
+void PlanSetWriter::write_plan(const Plan &plan, int cost) {
+    record.clear();
+    plan_set::append_varint(record, cost);
+    plan_set::append_varint(record, plan.size());
+    for (const GlobalOperator *op : plan)
+        plan_set::append_varint(record, op->get_index());
+    if (with_states) {
+        vector<StateID> trace;
+        search_space.trace_from_plan(plan, trace);
+        append_state(state_registry.get_initial_state());
+        for (StateID id : trace)
+            append_state(state_registry.lookup_state(id));
+    }
+    plan_offsets.push_back(out.tellp());
+    write_raw(record.data(), record.size());
+}
+
+void PlanSetWriter::finish() {
+    header.num_plans = plan_offsets.size();
+    plan_offsets.push_back(out.tellp());
+    pad();
+    header.plan_index = out.tellp();
+    write_raw(plan_offsets.data(), plan_offsets.size() * sizeof(uint64_t));
+    out.seekp(0);
+    write_raw(&header, sizeof(header));
+    out.close();
+    if (!out) {
+        cerr << "Could not write plan set file" << endl;
+        utils::exit_with(ExitCode::CRITICAL_ERROR);
+    }
+}
+}
@@ -0,0 +1,43 @@
+#ifndef KSTAR_PLAN_SET_WRITER_H
+#define KSTAR_PLAN_SET_WRITER_H
+
+#include "kstar_types.h"
+#include "plan_set_format.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+class SearchSpace;
+class StateRegistry;
+
+namespace kstar {
+// Writes plans to a file in the plan set format (see plan_set_format.h)
+class PlanSetWriter {
+    std::ofstream out;
+    StateRegistry &state_registry;
+    const SearchSpace &search_space;
+    const bool with_states;
+    plan_set::PlanSetHeader header;
+    // Index of each fact in the fact table by variable and value, or -1
+    // if the fact is not shown in states
+    std::vector<std::vector<int>> fact_ids;
+    std::vector<uint64_t> plan_offsets;
+    std::string record;
+
+    void write_raw(const void *data, size_t size);
+    void pad();
+    void write_string_table(const std::vector<std::string> &strings);
+    void append_state(const GlobalState &state);
+public:
+    PlanSetWriter(const std::string &filename,
+                  StateRegistry &state_registry,
+                  const SearchSpace &search_space,
+                  bool with_states);
+    void write_plan(const Plan &plan, int cost);
+    // Write the plan index and the final header
+    void finish();
+};
+}
+
+#endif
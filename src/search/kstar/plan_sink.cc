@@ -0,0 +1,140 @@
+#include "plan_sink.h"
+
+#include "../globals.h"
+#include "../option_parser.h"
+
+#include "../utils/json.h"
+#include "../utils/system.h"
+
+#include <iostream>
+
+using namespace std;
+using utils::ExitCode;
+
+namespace kstar {
+static void open_or_exit(ofstream &out, const string &filename,
+                         ios_base::openmode mode) {
+    out.open(filename, mode);
+    if (!out) {
+        cerr << "Could not open plan file " << filename << endl;
+        utils::exit_with(ExitCode::CRITICAL_ERROR);
+    }
+}
+
+void FilePlanSink::write_plan(const Plan &plan, int) {
+    save_plan(plan, true);
+}
+
+// Cut the file down to position and continue writing at its end
+static void reopen_or_exit(ofstream &out, const string &filename,
+                           int64_t position, ios_base::openmode mode) {
+    if (!utils::truncate_file(filename, position)) {
+        cerr << "Could not truncate plan file " << filename << endl;
+        utils::exit_with(ExitCode::CRITICAL_ERROR);
+    }
+    open_or_exit(out, filename, mode | ios_base::in);
+    out.seekp(0, ios_base::end);
+}
+
+NdjsonPlanSink::NdjsonPlanSink(const string &filename, bool resume)
+    : filename(filename) {
+    if (!resume)
+        open_or_exit(out, filename, ios_base::out);
+}
+
+void NdjsonPlanSink::write_plan(const Plan &plan, int cost) {
+    out << "{\"cost\": " << cost << ", \"actions\": [";
+    for (size_t i = 0; i < plan.size(); ++i) {
+        if (i > 0)
+            out << ", ";
+        utils::write_json_string(out, plan[i]->get_name());
+    }
+    out << "]}\n";
+    out.flush();
+    ++g_num_previously_generated_plans;
+}
+
+int64_t NdjsonPlanSink::get_position() {
+    return out.tellp();
+}
+
+void NdjsonPlanSink::resume_at(int64_t position) {
+    reopen_or_exit(out, filename, position, ios_base::out);
+}
+
+BinaryPlanSink::BinaryPlanSink(const string &filename, bool resume)
+    : filename(filename) {
+    if (resume)
+        return;
+    open_or_exit(out, filename, ios_base::out | ios_base::binary);
+    write_int(MAGIC);
+    write_int(VERSION);
+    write_int(g_operators.size());
+    for (const GlobalOperator &op : g_operators) {
+        const string &name = op.get_name();
+        write_int(name.size());
+        out.write(name.data(), name.size());
+    }
+    out.flush();
+}
+
+void BinaryPlanSink::write_int(int value) {
+    int32_t data = value;
+    out.write(reinterpret_cast<const char *>(&data), sizeof(data));
+}
+
+void BinaryPlanSink::write_plan(const Plan &plan, int cost) {
+    write_int(cost);
+    write_int(plan.size());
+    for (const GlobalOperator *op : plan)
+        write_int(op->get_index());
+    out.flush();
+    ++g_num_previously_generated_plans;
+}
+
+int64_t BinaryPlanSink::get_position() {
+    return out.tellp();
+}
+
+void BinaryPlanSink::resume_at(int64_t position) {
+    reopen_or_exit(out, filename, position, ios_base::out | ios_base::binary);
+}
+
+void add_plan_sink_options(OptionParser &parser) {
+    vector<string> sinks;
+    vector<string> sink_docs;
+    sinks.push_back("files");
+    sink_docs.push_back(
+        "files: one file per plan in found_plans");
+    sinks.push_back("ndjson");
+    sink_docs.push_back(
+        "ndjson: one JSON object per plan and line in a single file");
+    sinks.push_back("binary");
+    sink_docs.push_back(
+        "binary: a stream of operator indices in a single file");
+    parser.add_enum_option(
+        "plan_sink",
+        sinks,
+        "How to write the plans found.",
+        "files",
+        sink_docs);
+    parser.add_option<string>(
+        "plan_sink_file",
+        "File for the ndjson and binary plan sinks "
+        "(default: the plan file name with extension .ndjson or .bin)",
+        OptionParser::NONE);
+}
+
+unique_ptr<PlanSink> create_plan_sink(const Options &opts, bool resume) {
+    PlanSinkType type = static_cast<PlanSinkType>(opts.get_enum("plan_sink"));
+    if (type == PlanSinkType::FILES)
+        return unique_ptr<PlanSink>(new FilePlanSink());
+    string filename = g_plan_filename;
+    filename += type == PlanSinkType::NDJSON ? ".ndjson" : ".bin";
+    if (opts.contains("plan_sink_file"))
+        filename = opts.get<string>("plan_sink_file");
+    if (type == PlanSinkType::NDJSON)
+        return unique_ptr<PlanSink>(new NdjsonPlanSink(filename, resume));
+    return unique_ptr<PlanSink>(new BinaryPlanSink(filename, resume));
+}
+}
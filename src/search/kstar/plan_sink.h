@@ -0,0 +1,86 @@
+#ifndef KSTAR_PLAN_SINK_H
+#define KSTAR_PLAN_SINK_H
+
+#include "kstar_types.h"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace options {
+class OptionParser;
+class Options;
+}
+
+namespace kstar {
+enum class PlanSinkType {
+    FILES,
+    NDJSON,
+    BINARY
+};
+
+/*
+  Receives the plans K* accepts, in the order they are written. Sinks
+  that write a single stream flush it after every plan, so consumers
+  can read plans while the search continues.
+*/
+class PlanSink {
+public:
+    virtual ~PlanSink() = default;
+    virtual void write_plan(const Plan &plan, int cost) = 0;
+    /*
+      Position after the plans written so far. A sink created to resume a
+      checkpointed run (see create_plan_sink) drops what was written after
+      the position saved with the checkpoint and continues there. Sinks
+      without a single stream have nothing to drop.
+    */
+    virtual int64_t get_position() {return 0; }
+    virtual void resume_at(int64_t) {}
+};
+
+// One file per plan (found_plans/<plan file>.N), see save_plan. The files
+// are numbered by g_num_previously_generated_plans.
+class FilePlanSink : public PlanSink {
+public:
+    virtual void write_plan(const Plan &plan, int cost) override;
+};
+
+// One JSON object {"cost": ..., "actions": [...]} per line
+class NdjsonPlanSink : public PlanSink {
+    const std::string filename;
+    std::ofstream out;
+public:
+    NdjsonPlanSink(const std::string &filename, bool resume);
+    virtual void write_plan(const Plan &plan, int cost) override;
+    virtual int64_t get_position() override;
+    virtual void resume_at(int64_t position) override;
+};
+
+/*
+  Binary stream of 32-bit integers in native byte order. The header is the
+  magic number, the format version and the number of operators followed
+  by the name of each operator (length, then characters). Each plan is
+  a record of its cost, its length and the operator indices.
+*/
+class BinaryPlanSink : public PlanSink {
+    const std::string filename;
+    std::ofstream out;
+    void write_int(int value);
+public:
+    static const int MAGIC = 0x4b504c4e;
+    static const int VERSION = 1;
+
+    BinaryPlanSink(const std::string &filename, bool resume);
+    virtual void write_plan(const Plan &plan, int cost) override;
+    virtual int64_t get_position() override;
+    virtual void resume_at(int64_t position) override;
+};
+
+void add_plan_sink_options(options::OptionParser &parser);
+// A sink created to resume a run does not touch its file until resume_at
+std::unique_ptr<PlanSink> create_plan_sink(const options::Options &opts,
+                                           bool resume = false);
+}
+
+#endif
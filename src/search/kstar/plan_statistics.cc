@@ -0,0 +1,190 @@
+#include "plan_statistics.h"
+
+#include "../globals.h"
+#include "../option_parser.h"
+#include "../plugin.h"
+
+#include "../utils/json.h"
+#include "../utils/system.h"
+
+#include <fstream>
+
+using namespace std;
+
+namespace kstar {
+// Facts that SearchSpace::dump_state leaves out
+static bool is_hidden_fact(const string &fact_name) {
+    return fact_name == "<none of those>" ||
+           fact_name.compare(0, 11, "NegatedAtom") == 0;
+}
+
+PlanStatistics::PlanStatistics(const options::Options &opts)
+    : PathSpaceSearch(opts) {
+    if (opts.contains("json_file_to_dump"))
+        json_filename = opts.get<string>("json_file_to_dump");
+}
+
+void PlanStatistics::collect_operators(const PathSpace &path_space,
+                                       const vector<PathSpace::Count> &op_occurrences,
+                                       vector<Occurrence> &operators) const {
+    for (size_t op_index = 0; op_index < op_occurrences.size(); ++op_index) {
+        if (op_occurrences[op_index] == 0)
+            continue;
+        bool in_all_plans = !path_space.has_plan_without_operator(op_index);
+        operators.push_back(Occurrence {g_operators[op_index].get_name(),
+                                        op_occurrences[op_index],
+                                        in_all_plans});
+    }
+}
+
+/*
+  A fact occurs on a plan if a state on it holds the fact. Facts of the
+  initial state occur on all plans. For any other fact, the plans are
+  searched again without the states that hold it. The goal state and the
+  variable of the artificial goal operator are left out, since the goal
+  state only repeats the last state of the plan. So are the facts that
+  state dumps hide.
+*/
+int PlanStatistics::collect_facts(const PathSpace &path_space,
+                                  const vector<PathSpace::Count> &state_visits,
+                                  vector<Occurrence> &facts) {
+    int num_variables = g_variable_domain.size() - 1;
+    vector<vector<PathSpace::Count>> fact_visits(num_variables);
+    for (int var = 0; var < num_variables; ++var)
+        fact_visits[var].assign(g_variable_domain[var], 0);
+    vector<GlobalState> states_on_plans;
+    const PerStateInformation<SearchNodeInfo> &search_node_infos =
+        search_space.search_node_infos;
+    for (PerStateInformation<SearchNodeInfo>::const_iterator it =
+             search_node_infos.begin(&state_registry);
+         it != search_node_infos.end(&state_registry); ++it) {
+        PathSpace::Count visits = state_visits[(*it).get_value()];
+        if (visits == 0 || *it == goal_state)
+            continue;
+        GlobalState state = state_registry.lookup_state(*it);
+        states_on_plans.push_back(state);
+        for (int var = 0; var < num_variables; ++var) {
+            PathSpace::Count &count = fact_visits[var][state[var]];
+            count = PathSpace::add_counts(count, visits);
+        }
+    }
+
+    const GlobalState &initial_state = state_registry.get_initial_state();
+    vector<bool> holds_fact(state_registry.size(), false);
+    int num_facts = 0;
+    for (int var = 0; var < num_variables; ++var) {
+        for (int value = 0; value < g_variable_domain[var]; ++value) {
+            if (is_hidden_fact(g_fact_names[var][value]))
+                continue;
+            ++num_facts;
+            if (fact_visits[var][value] == 0)
+                continue;
+            bool in_all_plans = initial_state[var] == value;
+            if (!in_all_plans) {
+                for (const GlobalState &state : states_on_plans)
+                    holds_fact[state.get_id().get_value()] = state[var] == value;
+                in_all_plans = !path_space.has_plan_without_states(holds_fact);
+            }
+            facts.push_back(Occurrence {g_fact_names[var][value],
+                                        fact_visits[var][value],
+                                        in_all_plans});
+        }
+    }
+    return num_facts;
+}
+
+void PlanStatistics::dump(const string &title,
+                          const vector<Occurrence> &occurrences,
+                          int num_total) const {
+    int num_in_all_plans = 0;
+    cout << title << " on all plans:" << endl;
+    for (const Occurrence &occurrence : occurrences) {
+        if (occurrence.in_all_plans) {
+            cout << "  " << occurrence.name << " (" << occurrence.count
+                 << " occurrences)" << endl;
+            ++num_in_all_plans;
+        }
+    }
+    cout << title << " on all plans: " << num_in_all_plans
+         << ", on some plans: " << occurrences.size() - num_in_all_plans
+         << ", on no plan: " << num_total - occurrences.size() << endl;
+}
+
+void PlanStatistics::dump_json(int bound, PathSpace::Count num_plans,
+                               const vector<Occurrence> &operators,
+                               const vector<Occurrence> &facts) const {
+    ofstream os(json_filename.c_str());
+    os << "{ \"optimal_cost\" : " << optimal_solution_cost << "," << endl;
+    os << "\"bound\" : " << bound << "," << endl;
+    os << "\"plans\" : " << num_plans << "," << endl;
+    for (int i = 0; i < 2; ++i) {
+        const vector<Occurrence> &occurrences = i == 0 ? operators : facts;
+        os << (i == 0 ? "\"operators\"" : "\"facts\"") << " : [" << endl;
+        for (size_t j = 0; j < occurrences.size(); ++j) {
+            const Occurrence &occurrence = occurrences[j];
+            if (j > 0)
+                os << "," << endl;
+            os << "{ \"name\" : ";
+            utils::write_json_string(os, occurrence.name);
+            os << ", \"occurrences\" : " << occurrence.count << ", "
+               << "\"in_all_plans\" : "
+               << (occurrence.in_all_plans ? "true" : "false") << "}";
+        }
+        os << "]" << (i == 0 ? "," : "}") << endl;
+    }
+}
+
+void PlanStatistics::analyze(const PathSpace &path_space) {
+    if (path_space.has_infinitely_many_plans()) {
+        cerr << "Cannot count occurrences: a zero-cost cycle lies on plans "
+             << "of cost at most " << path_space.get_bound() << endl;
+        utils::exit_with(utils::ExitCode::UNSUPPORTED);
+    }
+    PathSpace::Count num_plans = 0;
+    for (int cost = 0; cost <= path_space.get_bound(); ++cost)
+        num_plans = PathSpace::add_counts(num_plans, path_space.count_plans(cost));
+    vector<PathSpace::Count> op_occurrences;
+    vector<PathSpace::Count> state_visits;
+    path_space.count_occurrences(op_occurrences, state_visits);
+
+    vector<Occurrence> operators;
+    collect_operators(path_space, op_occurrences, operators);
+    vector<Occurrence> facts;
+    int num_facts = collect_facts(path_space, state_visits, facts);
+    cout << "Plans of cost at most " << path_space.get_bound() << ": "
+         << num_plans << endl;
+    dump("Operators", operators, op_occurrences.size());
+    dump("Facts", facts, num_facts);
+    if (!json_filename.empty())
+        dump_json(path_space.get_bound(), num_plans, operators, facts);
+}
+
+static SearchEngine *_parse(OptionParser &parser) {
+    parser.document_synopsis(
+        "Plan statistics",
+        "Counts how often each operator and each fact occurs on the plans "
+        "of cost at most q times the optimal cost, and finds the operators "
+        "and facts that occur on all of them. These are the plans that "
+        "kstar finds with the same q. A fact occurs on a plan if a state "
+        "on it holds the fact, and a plan that applies an operator or "
+        "visits a state twice counts twice. The occurrences are counted "
+        "by dynamic programming over the numbers of walks from the initial "
+        "state and to the goal, without enumerating the plans. Whether an "
+        "operator or fact occurs on all plans is decided by a search for "
+        "a plan without it.");
+    add_path_space_search_options(parser);
+    parser.add_option<string>("json_file_to_dump",
+        "A path to the json file to dump the statistics to",
+        OptionParser::NONE);
+    Options opts = parser.parse();
+
+    PlanStatistics *engine = nullptr;
+    if (!parser.dry_run()) {
+        set_path_space_search_options(opts);
+        engine = new PlanStatistics(opts);
+    }
+    return engine;
+}
+
+static Plugin<SearchEngine> _plugin("kstar_stats", _parse);
+}
@@ -0,0 +1,44 @@
+#ifndef KSTAR_PLAN_STATISTICS_H
+#define KSTAR_PLAN_STATISTICS_H
+
+#include "path_space.h"
+#include "path_space_search.h"
+
+#include <string>
+#include <vector>
+
+namespace kstar {
+/*
+  How often the operators and facts occur on the plans of cost at most
+  q times the optimal cost, and which of them occur on all plans.
+*/
+class PlanStatistics : public PathSpaceSearch {
+    struct Occurrence {
+        std::string name;
+        PathSpace::Count count;
+        bool in_all_plans;
+    };
+
+    std::string json_filename;
+
+    void collect_operators(const PathSpace &path_space,
+                           const std::vector<PathSpace::Count> &op_occurrences,
+                           std::vector<Occurrence> &operators) const;
+    // Return the number of facts, including those on no plan
+    int collect_facts(const PathSpace &path_space,
+                      const std::vector<PathSpace::Count> &state_visits,
+                      std::vector<Occurrence> &facts);
+    void dump(const std::string &title,
+              const std::vector<Occurrence> &occurrences, int num_total) const;
+    void dump_json(int bound, PathSpace::Count num_plans,
+                   const std::vector<Occurrence> &operators,
+                   const std::vector<Occurrence> &facts) const;
+protected:
+    virtual void analyze(const PathSpace &path_space) override;
+public:
+    explicit PlanStatistics(const options::Options &opts);
+    virtual ~PlanStatistics() = default;
+};
+}
+
+#endif
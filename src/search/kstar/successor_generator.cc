@@ -5,55 +5,57 @@ using namespace std;
 
 namespace kstar {
 
-SuccessorGenerator::SuccessorGenerator(PerStateInformation<vector<Sap>> &tree_heap,
+SuccessorGenerator::SuccessorGenerator(const SapArena &saps,
+                                       PerStateInformation<TreeHeapEntry> &tree_heap,
+                                       const TreeHeap &tree_heap_nodes,
                                        PerStateInformation<vector<Sap>> &incoming_heap,
-                                          std::unordered_map<Node, Node> &parent_sap,
-                                       std::unordered_set<Edge> &cross_edge,
                                        StateRegistry* state_registry) :
+                                               saps(saps),
                                                tree_heap(tree_heap),
+                                               tree_heap_nodes(tree_heap_nodes),
                                                incomming_heap(incoming_heap),
-                                               parent_node(parent_sap),
-                                               cross_edge(cross_edge),
                                                state_registry(state_registry) {
 }
 
 // For each node carrying an edge (u,v) we attach a pointer referring
 // to R(u) = top node of H_T[u]
-void SuccessorGenerator::add_cross_edge(Node &node,
-                                        vector<Node> &successors,
-                                        bool successors_only) {
+void SuccessorGenerator::add_cross_edge(const Node &node,
+                                        vector<Node> &successors) {
 
-    GlobalState u = state_registry->lookup_state(node.sap->from);
-    if (tree_heap[u].empty())
-        return;
-    int succ_g = node.g + get_cost_cross_edge(tree_heap[u].front());
-    Node succ_node(succ_g, tree_heap[u].front(), u.get_id());
+    GlobalState u = saps.get_from_state(node.sap);
+    add_cross_edge(node, u.get_id(), tree_heap[u].root, successors);
+}
 
-    if (!successors_only) {
-        succ_node.id = g_djkstra_nodes;
-        ++g_djkstra_nodes;
-        set_parent(node, succ_node, true);
-    }
+// Cross edge from node to a tree heap of u with the given root. This is
+// not H_T(u) for edges that A* found after node was expanded.
+void SuccessorGenerator::add_cross_edge(const Node &node, StateID u,
+                                        int heap_root,
+                                        vector<Node> &successors) {
+    if (heap_root == TreeHeap::NONE)
+        return;
+    Sap succ_sap = tree_heap_nodes[heap_root].sap;
+    int succ_g = node.g + get_cost_cross_edge(succ_sap, saps);
+    Node succ_node(succ_g, succ_sap, u);
+    succ_node.heap_node = heap_root;
+    succ_node.cross_edge = true;
 
     successors.push_back(succ_node);
 }
 
 // Aljazzar and Leue: edge (u,v)
 // root_in(v) keeps its only child from H_in (v).
-void SuccessorGenerator::add_inheap_successors(Node &node,
-                                               vector<Node> &successors,
-                                               bool successors_only){
-    GlobalState s  = node.sap->get_to_state();
-    for (size_t i = 1; i < incomming_heap[s].size(); ++i) {
-        Sap &sap = incomming_heap[s][i];
-        int succ_g = node.g + get_cost_heap_edge(node.sap, sap);
+// Each generation of H_in(v) is a heap of its own.
+void SuccessorGenerator::add_inheap_successors(const Node &node,
+                                               vector<Node> &successors) {
+    GlobalState s  = saps.get_to_state(node.sap);
+    const vector<Sap> &in_heap = incomming_heap[s];
+    pair<size_t, size_t> range =
+        get_generation_range(in_heap, saps[node.sap].generation, saps);
+    for (size_t i = range.first + 1; i < range.second; ++i) {
+        Sap sap = in_heap[i];
+        int succ_g = node.g + get_cost_heap_edge(node.sap, sap, saps);
         Node succ_node(succ_g, sap, node.heap_state);
-        if (!successors_only) {
-            succ_node.is_inheap_node = true;
-            succ_node.id = g_djkstra_nodes;
-            ++g_djkstra_nodes;
-            set_parent(node, succ_node, false);
-        }
+        succ_node.is_inheap_node = true;
 
         successors.push_back(succ_node);
     }
@@ -61,98 +63,54 @@ void SuccessorGenerator::add_inheap_successors(Node &node,
 
 // Checks whether node is the root of the incomming
 // heap for its corresponding heap_state
-bool SuccessorGenerator::is_inheap_top(Node &node) {
-    GlobalState s = node.sap->get_to_state();
-    if (node.sap == incomming_heap[s].front())
+bool SuccessorGenerator::is_inheap_top(const Node &node) {
+    GlobalState s = saps.get_to_state(node.sap);
+    const vector<Sap> &in_heap = incomming_heap[s];
+    size_t begin =
+        get_generation_range(in_heap, saps[node.sap].generation, saps).first;
+    if (begin < in_heap.size() && node.sap == in_heap[begin])
         return true;
     return false;
 }
 
-// check whether node is the root of the treeheap
-bool SuccessorGenerator::is_treeheap_top(Node &node) {
-    GlobalState s = state_registry->lookup_state(node.heap_state);
-    if (node.sap == tree_heap[s].front())
-        return true;
-    return false;
-}
-
-void SuccessorGenerator::add_treeheap_successors(Node &node,
-                                                 vector<Node> &successors,
-                                                 bool successors_only) {
-    GlobalState s = state_registry->lookup_state(node.heap_state);
-    for (size_t i = 1; i < tree_heap[s].size(); ++i) {
-        Sap &sap = tree_heap[s][i];
-        int succ_g = node.g + get_cost_heap_edge(node.sap, sap);
-        Node succ_node(succ_g, sap, s.get_id());
-        if (!successors_only) {
-            succ_node.id = g_djkstra_nodes;
-            ++g_djkstra_nodes;
-            set_parent(node, succ_node, false);
-        }
+// The successors of a tree heap node are its children in H_T
+void SuccessorGenerator::add_treeheap_successors(const Node &node,
+                                                 vector<Node> &successors) {
+    const TreeHeapNode &heap_node = tree_heap_nodes[node.heap_node];
+    for (int child : {heap_node.left, heap_node.right}) {
+        if (child == TreeHeap::NONE)
+            continue;
+        Sap sap = tree_heap_nodes[child].sap;
+        int succ_g = node.g + get_cost_heap_edge(node.sap, sap, saps);
+        Node succ_node(succ_g, sap, node.heap_state);
+        succ_node.heap_node = child;
 
         successors.push_back(succ_node);
     }
 }
 
-void SuccessorGenerator::get_successors(Node &node,
-                                        vector<Node> &successors,
-                                        bool successors_only) {
+void SuccessorGenerator::get_successors(const Node &node,
+                                        vector<Node> &successors) {
 
-    add_cross_edge(node, successors, successors_only);
+    add_cross_edge(node, successors);
     if (is_inheap_top(node)) {
-        add_inheap_successors(node, successors, successors_only);
-    }
-
-    if (is_treeheap_top(node) && !node.is_inheap_node) {
-        add_treeheap_successors(node, successors, successors_only);
-    }
-}
-
-
-int SuccessorGenerator::get_max_successor_delta(Node& node,
-                                                shared_ptr<Node> pg_root) {
-    GlobalState s = state_registry->lookup_state(node.sap->to);
-    int max = -1;
-    vector<Node> successors;
-
-    // is root node
-    if(node.sap->from == StateID::no_state) {
-        Node succ;
-        get_successor_pg_root(pg_root, succ, true);
-        successors.push_back(succ);
-    }
-    else {
-        get_successors(node, successors, true);
+        add_inheap_successors(node, successors);
     }
 
-    for(auto succ : successors) {
-        if (succ.sap->get_delta() > max) {
-            max = succ.sap->get_delta();
-        }
-    }
-    return max;
-}
-
-void SuccessorGenerator::set_parent(Node &node, Node succ_node, bool is_cross_edge) {
-    parent_node.insert(pair<Node, Node>(succ_node, node));
-    if (is_cross_edge) {
-        Edge e(node, succ_node);
-        cross_edge.insert(e);
+    if (node.heap_node != TreeHeap::NONE) {
+        add_treeheap_successors(node, successors);
     }
 }
 
 void SuccessorGenerator::get_successor_pg_root(shared_ptr<Node> pg_root,
-                                               Node &successor, bool successor_only) {
-    StateID goal_id = pg_root->sap->to;
+                                               Node &successor) {
+    StateID goal_id = saps[pg_root->sap].to;
     GlobalState goal_state = state_registry->lookup_state(goal_id);
-    Sap succ_sap = tree_heap[goal_state].front();
-    int succ_g = pg_root->g + get_cost_cross_edge(succ_sap);
+    int root = tree_heap[goal_state].root;
+    Sap succ_sap = tree_heap_nodes[root].sap;
+    int succ_g = pg_root->g + get_cost_cross_edge(succ_sap, saps);
     successor = Node(succ_g, succ_sap, goal_id);
-    if (successor_only)
-        return;
-    successor.id = g_djkstra_nodes;
-
-    set_parent(*pg_root, successor ,true);
-    ++g_djkstra_nodes;
+    successor.heap_node = root;
+    successor.cross_edge = true;
 }
 }
@@ -2,39 +2,38 @@
 #define KSTAR_SUCCESSOR_GENERATOR_H
 
 #include "kstar_types.h"
+#include "tree_heap.h"
 
 namespace kstar {
-
+/*
+  Generates the successors of path graph nodes. The successors are not
+  added to the path graph, which is up to the caller once the node is
+  expanded.
+*/
 class SuccessorGenerator {
-    PerStateInformation<vector<Sap>> &tree_heap;
+    const SapArena &saps;
+    PerStateInformation<TreeHeapEntry> &tree_heap;
+    const TreeHeap &tree_heap_nodes;
     PerStateInformation<vector<Sap>> &incomming_heap;
-    std::unordered_map<Node, Node> &parent_node;
-    std::unordered_set<Edge> &cross_edge;
     StateRegistry* state_registry;
 
 public:
-    SuccessorGenerator(PerStateInformation<vector<Sap>> &tree_heap,
+    SuccessorGenerator(const SapArena &saps,
+                       PerStateInformation<TreeHeapEntry> &tree_heap,
+                       const TreeHeap &tree_heap_nodes,
                        PerStateInformation<vector<Sap>> &incoming_heap,
-                       std::unordered_map<Node, Node> &parent_sap,
-                       std::unordered_set<Edge> &cross_edge,
                        StateRegistry* state_registry);
 
     virtual ~SuccessorGenerator() = default;
-    void get_successor_pg_root(shared_ptr<Node> pg_root,
-                               Node &successor, bool successor_only = false);
-    void set_parent(Node &node, Node succ_node, bool is_cross_edge);
+    void get_successor_pg_root(shared_ptr<Node> pg_root, Node &successor);
 
-    void get_successors(Node &sap, vector<Node> &successor_sap,
-                        bool successors_only = false);
-    int get_max_successor_delta(Node& sap, shared_ptr<Node> pg_root);
-    void add_cross_edge(Node &p, vector<Node> &successors,
-                        bool successors_only = false);
-       void add_inheap_successors(Node &node, vector<Node> &successors,
-                               bool successor_only = false);
-    void add_treeheap_successors(Node &node, vector<Node> &successors,
-                               bool successor_only = false);
-    bool is_inheap_top(Node &node);
-    bool is_treeheap_top(Node &node);
+    void get_successors(const Node &node, vector<Node> &successors);
+    void add_cross_edge(const Node &node, vector<Node> &successors);
+    void add_cross_edge(const Node &node, StateID u, int heap_root,
+                        vector<Node> &successors);
+    void add_inheap_successors(const Node &node, vector<Node> &successors);
+    void add_treeheap_successors(const Node &node, vector<Node> &successors);
+    bool is_inheap_top(const Node &node);
 };
 }
 #endif
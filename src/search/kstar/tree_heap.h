@@ -0,0 +1,146 @@
+#ifndef KSTAR_TREE_HEAP_H
+#define KSTAR_TREE_HEAP_H
+
+#include "checkpoint.h"
+#include "kstar_types.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace kstar {
+/*
+  Persistent leftist heap used to represent the tree heaps H_T(s) of
+  the path graph (Eppstein 1998).
+
+  H_T(s) is obtained from H_T(parent(s)) by inserting the top of the
+  incoming heap of s. Insertion copies only the nodes on the right spine
+  of the heap, which has O(log n) nodes, and shares all other nodes with
+  H_T(parent(s)). Hence the tree heaps of all states need O(log depth)
+  memory per state instead of O(depth).
+
+  Nodes are addressed by their index in the node pool and are never
+  removed, so a heap root stays valid for as long as the TreeHeap lives.
+
+  Incoming edges are grouped by the generation in which A* found them
+  (see StateActionPair::generation) and every generation of an incoming
+  heap is a separate heap. K* builds two kinds of tree heaps on top of
+  them: H_T(s) with the tops of all generations, used by path graph
+  nodes expanded in the current Dijkstra run, and generation heaps with
+  the tops of a single generation, used to connect nodes expanded in
+  earlier runs to the edges A* found since.
+*/
+struct TreeHeapNode {
+    Sap sap;
+    int left;
+    int right;
+    int rank;
+
+    TreeHeapNode(Sap sap, int left, int right, int rank)
+        : sap(sap), left(left), right(right), rank(rank) {
+    }
+};
+
+class TreeHeap {
+    const SapArena &saps;
+    std::vector<TreeHeapNode> nodes;
+
+    int get_rank(int node) const {
+        return node == NONE ? 0 : nodes[node].rank;
+    }
+
+    int add_node(Sap sap, int left, int right) {
+        if (get_rank(left) < get_rank(right))
+            std::swap(left, right);
+        nodes.emplace_back(sap, left, right, get_rank(right) + 1);
+        return nodes.size() - 1;
+    }
+public:
+    static const int NONE = -1;
+
+    explicit TreeHeap(const SapArena &saps)
+        : saps(saps) {
+    }
+
+    /*
+      Return the root of a heap containing all elements of the heap with
+      the given root and sap. The heap with the given root is unchanged.
+      The recursion follows the right spine and is therefore bounded by
+      O(log n).
+    */
+    int insert(int root, Sap sap) {
+        if (root == NONE || saps.less(sap, nodes[root].sap))
+            return add_node(sap, root, NONE);
+        Sap root_sap = nodes[root].sap;
+        int left = nodes[root].left;
+        int right = insert(nodes[root].right, sap);
+        return add_node(root_sap, left, right);
+    }
+
+    const TreeHeapNode &operator[](int node) const {
+        assert(node >= 0 && node < static_cast<int>(nodes.size()));
+        return nodes[node];
+    }
+
+    // Collect all nodes of the heap with the given root in pre-order.
+    void get_nodes(int root, std::vector<int> &result) const {
+        std::vector<int> stack;
+        if (root != NONE)
+            stack.push_back(root);
+        while (!stack.empty()) {
+            int node = stack.back();
+            stack.pop_back();
+            result.push_back(node);
+            if (nodes[node].right != NONE)
+                stack.push_back(nodes[node].right);
+            if (nodes[node].left != NONE)
+                stack.push_back(nodes[node].left);
+        }
+    }
+
+    size_t size() const {
+        return nodes.size();
+    }
+
+    // Write all nodes in bulk, and replace them by the nodes read back
+    void write(std::ostream &out) const {
+        write_vector(out, nodes);
+    }
+
+    bool read(std::istream &in) {
+        return read_vector(in, nodes);
+    }
+};
+
+// Root of H_T(s) together with the bookkeeping needed for memoization.
+struct TreeHeapEntry {
+    int root = TreeHeap::NONE;
+    // Epoch in which the heap was (re)built, -1 if never built.
+    int built = -1;
+    // Epoch in which the top of the incoming heap of s last changed.
+    int changed = -1;
+    // Epoch in which the heap was last checked to be up to date.
+    int validated = -1;
+    // Root of the tree heap of a single generation and that generation.
+    int generation_root = TreeHeap::NONE;
+    int generation = -1;
+};
+
+/*
+  Incoming heaps are sorted by generation first (see GenerationCmp).
+  Return the range [begin, end) of the edges of the given generation.
+*/
+inline std::pair<size_t, size_t> get_generation_range(
+    const std::vector<Sap> &in_heap, int generation, const SapArena &saps) {
+    auto begin = std::lower_bound(
+        in_heap.begin(), in_heap.end(), generation,
+        [&saps](Sap sap, int g) {return saps[sap].generation < g;});
+    auto end = std::upper_bound(
+        begin, in_heap.end(), generation,
+        [&saps](int g, Sap sap) {return g < saps[sap].generation;});
+    return std::make_pair(begin - in_heap.begin(), end - in_heap.begin());
+}
+}
+
+#endif
@@ -1,5 +1,7 @@
 #include "util.h"
 
+#include "../globals.h"
+
 namespace kstar {
 
 bool is_self_loop(SearchNode node, SearchNode succ_node) {
@@ -8,34 +10,34 @@ bool is_self_loop(SearchNode node, SearchNode succ_node) {
     return false;
 }
 
-int get_cost_heap_edge(Sap &from, Sap &to) {
-    assert(to->get_delta() - from->get_delta() >= 0);
-    int cost_heap_edge = to->get_delta() - from->get_delta();
+int get_cost_heap_edge(Sap from, Sap to, const SapArena &saps) {
+    assert(saps.get_delta(to) - saps.get_delta(from) >= 0);
+    int cost_heap_edge = saps.get_delta(to) - saps.get_delta(from);
     return cost_heap_edge;
 }
 
-int get_cost_cross_edge(Sap &to) {
-    int cost_cross_edge = to->get_delta();
+int get_cost_cross_edge(Sap to, const SapArena &saps) {
+    int cost_cross_edge = saps.get_delta(to);
     return cost_cross_edge;
 }
 
-void print_tree_heap(vector<Sap> &v) {
+void print_tree_heap(vector<Sap> &v, const SapArena &saps) {
     for (size_t i = 0; i < v.size(); ++i) {
         Sap sap = v[i];
-        cout << "(" << sap->get_from_state().get_state_tuple() << ","
-             << sap->get_to_state().get_state_tuple() << ")" << endl;
+        cout << "(" << saps.get_from_state(sap).get_state_tuple() << ","
+             << saps.get_to_state(sap).get_state_tuple() << ")" << endl;
     }
 }
 
-std::string get_node_name(Node &p, StateRegistry *state_registry) {
+std::string get_node_name(Node &p, const SapArena &saps) {
     std::string str;
-    if (p.sap->from == StateID::no_state) {
+    if (saps[p.sap].from == StateID::no_state) {
         return "R";
     }
 
-    GlobalState s = p.sap->get_from_state();
-    GlobalState succ = p.sap->get_to_state();
-    GlobalState heap_s = state_registry->lookup_state(p.heap_state);
+    GlobalState s = saps.get_from_state(p.sap);
+    GlobalState succ = saps.get_to_state(p.sap);
+    GlobalState heap_s = saps.get_state_registry()->lookup_state(p.heap_state);
 
 
     str = "(" + s.get_state_tuple() + ","\
@@ -43,44 +45,44 @@ std::string get_node_name(Node &p, StateRegistry *state_registry) {
     return str;
 }
 
-void notify_generate(Node &p, StateRegistry *state_registry) {
-    std::string node_name = get_node_name(p, state_registry);
+void notify_generate(Node &p, const SapArena &saps) {
+    std::string node_name = get_node_name(p, saps);
     std::cout << "Generating node " << node_name << " from queue with g=" << p.g << std::endl;
 }
 
-void notify_push(Node &node, StateRegistry *state_registry) {
+void notify_push(Node &node, const SapArena &saps) {
 
-    std::string node_name = get_node_name(node, state_registry);
-    cout << "Pushing " << node_name << " " << node.sap->op->get_name()
+    std::string node_name = get_node_name(node, saps);
+    cout << "Pushing " << node_name << " " << saps.get_op(node.sap)->get_name()
          << " g= " << node.g << " to queue "  << "with id=" << node.id << endl;
 }
 
-void notify_cross_edge(Node &node, StateRegistry *state_registry) {
-    std::string node_name = get_node_name(node, state_registry);
-    cout << "Pushing cross_edge" << node_name << " " << node.sap->op->get_name()
+void notify_cross_edge(Node &node, const SapArena &saps) {
+    std::string node_name = get_node_name(node, saps);
+    cout << "Pushing cross_edge" << node_name << " " << saps.get_op(node.sap)->get_name()
          << " g= " << node.g << " to queue" << " with id=" << node.id << endl;
 }
 
-void notify_inheap_edge(Node &node, StateRegistry *state_registry) {
-    std::string node_name = get_node_name(node, state_registry);
-    cout << "Pushing inheap_edge" << node_name << " " << node.sap->op->get_name()
+void notify_inheap_edge(Node &node, const SapArena &saps) {
+    std::string node_name = get_node_name(node, saps);
+    cout << "Pushing inheap_edge" << node_name << " " << saps.get_op(node.sap)->get_name()
          << " g= " << node.g << " to queue"  << " with id=" << node.id << endl<< endl;
 }
 
-void notify_tree_heap_edge(Node &node, StateRegistry *state_registry) {
-    std::string node_name = get_node_name(node, state_registry);
-    cout << "Pushing tree_heap edge" << node_name << " " << node.sap->op->get_name()
+void notify_tree_heap_edge(Node &node, const SapArena &saps) {
+    std::string node_name = get_node_name(node, saps);
+    cout << "Pushing tree_heap edge" << node_name << " " << saps.get_op(node.sap)->get_name()
          << " g= " << node.g << " to queue" << " with id=" << node.id << endl<< endl;
 }
 
-void notify_expand(Node &p, StateRegistry *state_registry, int &num_node_expansions) {
+void notify_expand(Node &p, const SapArena &saps, int &num_node_expansions) {
 
-    std::string node_name = get_node_name(p, state_registry);
+    std::string node_name = get_node_name(p, saps);
 
     if (node_name != "R") {
-        std::string op = p.sap->op->get_name();
+        std::string op = saps.get_op(p.sap)->get_name();
         std::cout << num_node_expansions + 1<< ". " << "Expanding node " << node_name << " "
-                  << op << " g=" << p.g << " " << p.sap->op->get_name()  << " id=" << p.id
+                  << op << " g=" << p.g << " " << saps.get_op(p.sap)->get_name()  << " id=" << p.id
                   << std::flush << std::endl;
     } else {
         std::cout << num_node_expansions + 1 << ". " << "Expanding node "
@@ -105,17 +107,17 @@ void add_dot_node(std::string id, std::string label, Stream &stream) {
     stream << "fillcolor=\"yellow\", label=\" "<< label << "\" ]" << endl;
 }
 
-std::string get_sap_id(Sap &sap, GlobalState s) {
-    std::string from = sap->get_from_state().get_state_tuple();
-    std::string to = sap->get_to_state().get_state_tuple();
+std::string get_sap_id(Sap sap, GlobalState s, const SapArena &saps) {
+    std::string from = saps.get_from_state(sap).get_state_tuple();
+    std::string to = saps.get_to_state(sap).get_state_tuple();
     std::string state_tuple = s.get_state_tuple();
     return from + to + state_tuple;
 }
 
 
-std::string get_sap_label(Sap &sap) {
-    std::string from = sap->get_from_state().get_state_tuple();
-    std::string to = sap->get_to_state().get_state_tuple();
+std::string get_sap_label(Sap sap, const SapArena &saps) {
+    std::string from = saps.get_from_state(sap).get_state_tuple();
+    std::string to = saps.get_to_state(sap).get_state_tuple();
     return from +" "+ to;
 }
 
@@ -146,4 +148,18 @@ void print_operator_sequence(Plan plan, std::string name) {
     }
     cout << "" << endl;
 }
+
+int find_operator(const std::string &name) {
+    size_t begin = name.find_first_not_of(" \t\r(");
+    size_t end = name.find_last_not_of(" \t\r)");
+    if (begin == std::string::npos)
+        return -1;
+    std::string stripped = name.substr(begin, end - begin + 1);
+    int num_operators = g_operators.size() - 1;
+    for (int op_index = 0; op_index < num_operators; ++op_index) {
+        if (g_operators[op_index].get_name() == stripped)
+            return op_index;
+    }
+    return -1;
+}
 }
@@ -3,6 +3,7 @@
 #include "doc_printer.h"
 #include "errors.h"
 #include "plugin.h"
+#include "plugin_objects.h"
 #include "synergy.h"
 #include "type_documenter.h"
 
@@ -321,6 +322,7 @@ SearchEngine *OptionParser::parse_cmd_line_aux(
                 throw ArgError("missing argument after --search");
             ++i;
             OptionParser p(args[i], dry_run);
+            PluginObjects::Scope collect_objects;
             engine = p.start_parsing<SearchEngine *>();
         } else if ((arg.compare("--help") == 0) && dry_run) {
             cout << "Help:" << endl;
@@ -393,6 +395,11 @@ string OptionParser::usage(string progname) {
         "    This planner call is part of a portfolio which already created\n"
         "    plan files FILENAME.1 up to FILENAME.COUNTER.\n"
         "    Start enumerating plan files with COUNTER+1, i.e. FILENAME.COUNTER+1\n\n"
+        "--server [OPTIONS]\n"
+        "    Reads the task once and then runs the planner for each further\n"
+        "    line of the input, which holds the OPTIONS of the run. OPTIONS\n"
+        "    given to --server form the first run. Predefinitions stay\n"
+        "    defined for later runs.\n\n"
         "See http://www.fast-downward.org/ for details.";
     return usage;
 }
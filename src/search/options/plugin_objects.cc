@@ -0,0 +1,63 @@
+#include "plugin_objects.h"
+
+#include "synergy.h"
+
+#include "../heuristic.h"
+#include "../search_engine.h"
+
+#include "../landmarks/landmark_factory.h"
+
+using namespace std;
+
+namespace options {
+template<typename T>
+static T *collect(bool collecting, vector<function<void()>> &deleters, T *obj) {
+    if (collecting && obj)
+        deleters.push_back([obj]() {delete obj; });
+    return obj;
+}
+
+PluginObjects::PluginObjects()
+    : collecting(false) {
+}
+
+PluginObjects *PluginObjects::instance() {
+    static PluginObjects instance_;
+    return &instance_;
+}
+
+PluginObjects::Scope::Scope() {
+    instance()->collecting = true;
+}
+
+PluginObjects::Scope::~Scope() {
+    instance()->collecting = false;
+}
+
+Heuristic *PluginObjects::add(Heuristic *obj) {
+    return collect(collecting, deleters, obj);
+}
+
+ScalarEvaluator *PluginObjects::add(ScalarEvaluator *obj) {
+    return collect(collecting, deleters, obj);
+}
+
+SearchEngine *PluginObjects::add(SearchEngine *obj) {
+    return collect(collecting, deleters, obj);
+}
+
+landmarks::LandmarkFactory *PluginObjects::add(landmarks::LandmarkFactory *obj) {
+    return collect(collecting, deleters, obj);
+}
+
+Synergy *PluginObjects::add(Synergy *obj) {
+    return collect(collecting, deleters, obj);
+}
+
+void PluginObjects::delete_collected() {
+    while (!deleters.empty()) {
+        deleters.back()();
+        deleters.pop_back();
+    }
+}
+}
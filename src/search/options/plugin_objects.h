@@ -0,0 +1,57 @@
+#ifndef OPTIONS_PLUGIN_OBJECTS_H
+#define OPTIONS_PLUGIN_OBJECTS_H
+
+#include <functional>
+#include <vector>
+
+class Heuristic;
+class ScalarEvaluator;
+class SearchEngine;
+
+namespace landmarks {
+class LandmarkFactory;
+}
+
+namespace options {
+class Synergy;
+
+/*
+  PluginObjects collects the plug-in objects held by raw pointers that
+  are created while the search engine is parsed: the engine itself and
+  the heuristics and evaluators that only it uses. Predefined objects
+  are created before and are not collected, since later queries of the
+  server may use them.
+
+  A planner run never deletes the collected objects. The server deletes
+  them after each query, which would leak them otherwise.
+*/
+class PluginObjects {
+    bool collecting;
+    std::vector<std::function<void()>> deleters;
+
+    PluginObjects();
+
+public:
+    static PluginObjects *instance();
+
+    // Collects the objects added while it exists
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+    };
+
+    // The objects are returned unchanged and may be nullptr
+    Heuristic *add(Heuristic *obj);
+    ScalarEvaluator *add(ScalarEvaluator *obj);
+    SearchEngine *add(SearchEngine *obj);
+    landmarks::LandmarkFactory *add(landmarks::LandmarkFactory *obj);
+    Synergy *add(Synergy *obj);
+
+    // Delete the collected objects in the reverse order of their
+    // creation, so that each object goes before the ones it uses
+    void delete_collected();
+};
+}
+
+#endif
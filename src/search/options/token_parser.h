@@ -1,6 +1,7 @@
 #ifndef OPTIONS_TOKEN_PARSER_H
 #define OPTIONS_TOKEN_PARSER_H
 
+#include "plugin_objects.h"
 #include "predefinitions.h"
 
 class Heuristic;
@@ -100,7 +101,8 @@ template<typename T>
 static T *lookup_in_registry(OptionParser &p) {
     ParseTree::iterator pt = p.get_parse_tree()->begin();
     if (Registry<T *>::instance()->contains(pt->value)) {
-        return Registry<T *>::instance()->get(pt->value) (p);
+        return PluginObjects::instance()->add(
+            Registry<T *>::instance()->get(pt->value) (p));
     }
     p.error(TypeNamer<T *>::name() + " " + pt->value + " not found");
     return 0;
@@ -152,10 +154,11 @@ inline ScalarEvaluator *TokenParser<ScalarEvaluator *>::parse(OptionParser &p) {
         return (ScalarEvaluator *)
                Predefinitions<Heuristic *>::instance()->get(pt->value);
     } else if (Registry<ScalarEvaluator *>::instance()->contains(pt->value)) {
-        return Registry<ScalarEvaluator *>::instance()->get(pt->value) (p);
+        return PluginObjects::instance()->add(
+            Registry<ScalarEvaluator *>::instance()->get(pt->value) (p));
     } else if (Registry<Heuristic *>::instance()->contains(pt->value)) {
-        return (ScalarEvaluator *)
-               Registry<Heuristic *>::instance()->get(pt->value) (p);
+        return (ScalarEvaluator *) PluginObjects::instance()->add(
+            Registry<Heuristic *>::instance()->get(pt->value) (p));
     }
     p.error("ScalarEvaluator " + pt->value + " not found");
     return 0;
@@ -10,6 +10,7 @@
 #include "utils/collections.h"
 
 #include <cassert>
+#include <cstdint>
 #include <iterator>
 #include <unordered_map>
 
@@ -204,6 +205,29 @@ public:
         return (*entries)[state_id];
     }
 
+    /*
+      Write the entries of the states of registry to out in bulk, and
+      replace them by entries read from in. Entry has to be trivially
+      copyable (see SegmentedVector::write).
+    */
+    void write_entries(const StateRegistry *registry, std::ostream &out) const {
+        const segmented_vector::SegmentedVector<Entry> *entries = get_entries(registry);
+        int64_t num_entries = entries ? entries->size() : 0;
+        out.write(reinterpret_cast<const char *>(&num_entries), sizeof(num_entries));
+        if (entries)
+            entries->write(out);
+    }
+
+    bool read_entries(const StateRegistry *registry, std::istream &in) {
+        int64_t num_entries;
+        if (!in.read(reinterpret_cast<char *>(&num_entries), sizeof(num_entries)) ||
+            num_entries < 0 || num_entries > static_cast<int64_t>(registry->size()))
+            return false;
+        segmented_vector::SegmentedVector<Entry> *entries = get_entries(registry);
+        entries->resize(0);
+        return entries->read(in, num_entries);
+    }
+
     void remove_state_registry(StateRegistry *registry) {
         delete entries_by_registry[registry];
         entries_by_registry.erase(registry);
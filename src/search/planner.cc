@@ -1,15 +1,146 @@
+#include "global_operator.h"
+#include "globals.h"
 #include "option_parser.h"
 #include "search_engine.h"
 
+#include "options/plugin_objects.h"
+
 #include "utils/system.h"
 #include "utils/timer.h"
 
+#include <cctype>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 using namespace std;
 using utils::ExitCode;
 
+static ExitCode run_search(SearchEngine *engine) {
+    utils::Timer search_timer;
+    engine->search();
+    search_timer.stop();
+    utils::g_timer.stop();
+
+    //engine->save_plan_if_necessary();
+    engine->print_statistics();
+    cout << "Search time: " << search_timer << endl;
+    cout << "Total time: " << utils::g_timer << endl;
+
+    if (engine->found_solution()) {
+        return ExitCode::PLAN_FOUND;
+    } else {
+        return ExitCode::UNSOLVED_INCOMPLETE;
+    }
+}
+
+// Split a query line into arguments at the spaces outside of parentheses
+static vector<string> split_query(const string &line) {
+    vector<string> args;
+    string arg;
+    int depth = 0;
+    for (char c : line) {
+        if (c == '(') {
+            ++depth;
+        } else if (c == ')') {
+            --depth;
+        } else if (isspace(c) && depth == 0) {
+            if (!arg.empty())
+                args.push_back(arg);
+            arg.clear();
+            continue;
+        }
+        arg += c;
+    }
+    if (!arg.empty())
+        args.push_back(arg);
+    return args;
+}
+
+static ExitCode run_query(const vector<string> &args, bool unit_cost) {
+    vector<const char *> argv;
+    argv.push_back("downward");
+    for (const string &arg : args)
+        argv.push_back(arg.c_str());
+    int argc = argv.size();
+
+    // Each query starts from the defaults of a fresh planner
+    g_plan_filename = "sas_plan";
+    g_num_previously_generated_plans = 0;
+    g_is_part_of_anytime_portfolio = false;
+    utils::g_timer.reset();
+    utils::g_timer.resume();
+
+    // The engine and the other objects created for the query (but not
+    // the predefined ones) are deleted once it is answered
+    options::PluginObjects *query_objects = options::PluginObjects::instance();
+    SearchEngine *engine = nullptr;
+    try {
+        OptionParser::parse_cmd_line(argc, argv.data(), true, unit_cost);
+        engine = OptionParser::parse_cmd_line(argc, argv.data(), false, unit_cost);
+    } catch (ArgError &error) {
+        cerr << error << endl;
+        query_objects->delete_collected();
+        return ExitCode::INPUT_ERROR;
+    } catch (ParseError &error) {
+        cerr << error << endl;
+        query_objects->delete_collected();
+        return ExitCode::INPUT_ERROR;
+    }
+    // Queries with predefinitions only
+    if (!engine)
+        return ExitCode::PLAN_FOUND;
+    ExitCode exit_code = run_search(engine);
+    query_objects->delete_collected();
+    cout << flush;
+    utils::report_exit_code_reentrant(exit_code);
+    return exit_code;
+}
+
+/*
+  Answer queries on the task read from the standard input. Each further
+  line of the standard input is a query with the arguments of a planner
+  run, e.g.
+
+    --search kstar(blind(), k=100, plan_sink=ndjson)
+
+  Arguments of the server itself form the first query. The answer to a
+  query is the output of the run, ending with the line
+  "[SERVER] Query done, exit code N", where N is the exit code of the
+  run. Heuristics predefined with --heuristic stay defined for all later
+  queries, which saves their precomputation. Heuristics given in the
+  --search argument are deleted with the engine once the query is
+  answered. Errors found when the search engine is created (e.g.
+  invalid bounds) still end the server.
+
+  Queries can change operator costs (kstar control files). The costs of
+  the task are restored after every query, however it ended.
+*/
+static void run_server(int argc, const char **argv) {
+    bool unit_cost = is_unit_cost();
+    vector<int> operator_costs;
+    for (const GlobalOperator &op : g_operators)
+        operator_costs.push_back(op.get_cost());
+    int min_action_cost = g_min_action_cost;
+    int max_action_cost = g_max_action_cost;
+    vector<string> args(argv + 2, argv + argc);
+    for (;;) {
+        if (!args.empty()) {
+            ExitCode exit_code = run_query(args, unit_cost);
+            for (size_t i = 0; i < g_operators.size(); ++i)
+                g_operators[i].set_cost(operator_costs[i]);
+            g_min_action_cost = min_action_cost;
+            g_max_action_cost = max_action_cost;
+            cout << "[SERVER] Query done, exit code "
+                 << static_cast<int>(exit_code) << endl;
+        }
+        string line;
+        if (!getline(cin, line))
+            break;
+        args = split_query(line);
+    }
+}
+
 int main(int argc, const char **argv) {
     utils::register_event_handlers();
 
@@ -21,6 +152,11 @@ int main(int argc, const char **argv) {
     if (string(argv[1]).compare("--help") != 0)
         read_everything(cin);
 
+    if (string(argv[1]) == "--server") {
+        run_server(argc, argv);
+        return 0;
+    }
+
     SearchEngine *engine = nullptr;
 
     // The command line is parsed twice: once in dry-run mode, to
@@ -38,19 +174,5 @@ int main(int argc, const char **argv) {
         utils::exit_with(ExitCode::INPUT_ERROR);
     }
 
-    utils::Timer search_timer;
-    engine->search();
-    search_timer.stop();
-    utils::g_timer.stop();
-
-    //engine->save_plan_if_necessary();
-    engine->print_statistics();
-    cout << "Search time: " << search_timer << endl;
-    cout << "Total time: " << utils::g_timer << endl;
-
-    if (engine->found_solution()) {
-        utils::exit_with(ExitCode::PLAN_FOUND);
-    } else {
-        utils::exit_with(ExitCode::UNSOLVED_INCOMPLETE);
-    }
+    utils::exit_with(run_search(engine));
 }
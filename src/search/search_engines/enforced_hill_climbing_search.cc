@@ -8,6 +8,8 @@
 #include "../evaluators/g_evaluator.h"
 #include "../evaluators/pref_evaluator.h"
 
+#include "../options/plugin_objects.h"
+
 #include "../open_lists/standard_scalar_open_list.h"
 #include "../open_lists/tiebreaking_open_list.h"
 
@@ -29,7 +31,8 @@ static shared_ptr<OpenListFactory> create_ehc_open_list_factory(
       ignore costs since EHC is supposed to implement a breadth-first
       search, not a uniform-cost search. So this seems to be a bug.
     */
-    ScalarEvaluator *g_evaluator = new GEval();
+    ScalarEvaluator *g_evaluator =
+        options::PluginObjects::instance()->add(new GEval());
 
     if (!use_preferred ||
         preferred_usage == PreferredUsage::PRUNE_BY_PREFERRED) {
@@ -54,7 +57,8 @@ static shared_ptr<OpenListFactory> create_ehc_open_list_factory(
           constructor that encapsulates this work to the tie-breaking
           open list code.
         */
-        vector<ScalarEvaluator *> evals = {g_evaluator, new PrefEval()};
+        vector<ScalarEvaluator *> evals = {
+            g_evaluator, options::PluginObjects::instance()->add(new PrefEval())};
         Options options;
         options.set("evals", evals);
         options.set("pref_only", false);
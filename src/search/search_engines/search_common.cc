@@ -6,6 +6,8 @@
 #include "../evaluators/sum_evaluator.h"
 #include "../evaluators/weighted_evaluator.h"
 
+#include "../options/plugin_objects.h"
+
 #include "../open_lists/alternation_open_list.h"
 #include "../open_lists/open_list_factory.h"
 #include "../open_lists/standard_scalar_open_list.h"
@@ -16,6 +18,7 @@
 using namespace std;
 
 namespace search_common {
+using options::PluginObjects;
 using GEval = g_evaluator::GEvaluator;
 using SumEval = sum_evaluator::SumEvaluator;
 using WeightedEval = weighted_evaluator::WeightedEvaluator;
@@ -88,8 +91,9 @@ static ScalarEvaluator *create_wastar_eval(
     if (w == 1)
         w_h_eval = h_eval;
     else
-        w_h_eval = new WeightedEval(h_eval, w);
-    return new SumEval(vector<ScalarEvaluator *>({g_eval, w_h_eval}));
+        w_h_eval = PluginObjects::instance()->add(new WeightedEval(h_eval, w));
+    return PluginObjects::instance()->add(
+        new SumEval(vector<ScalarEvaluator *>({g_eval, w_h_eval})));
 }
 
 shared_ptr<OpenListFactory> create_wastar_open_list_factory(
@@ -99,6 +103,7 @@ shared_ptr<OpenListFactory> create_wastar_open_list_factory(
     int w = options.get<int>("w");
 
     GEval *g_eval = new GEval();
+    PluginObjects::instance()->add(g_eval);
     vector<ScalarEvaluator *> f_evals;
     f_evals.reserve(base_evals.size());
     for (ScalarEvaluator *eval : base_evals)
@@ -113,8 +118,10 @@ shared_ptr<OpenListFactory> create_wastar_open_list_factory(
 pair<shared_ptr<OpenListFactory>, ScalarEvaluator *>
 create_astar_open_list_factory_and_f_eval(const Options &opts) {
     GEval *g = new GEval();
+    PluginObjects::instance()->add(g);
     ScalarEvaluator *h = opts.get<ScalarEvaluator *>("eval");
-    ScalarEvaluator *f = new SumEval(vector<ScalarEvaluator *>({g, h}));
+    ScalarEvaluator *f = PluginObjects::instance()->add(
+        new SumEval(vector<ScalarEvaluator *>({g, h})));
     vector<ScalarEvaluator *> evals = {f, h};
 
     Options options;
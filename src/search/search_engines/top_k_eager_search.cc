@@ -11,8 +11,13 @@
 #include "../successor_generator.h"
 #include "../utils/util.h"
 #include "../algorithms/ordered_set.h"
+#include "../algorithms/priority_queues.h"
 #include "../open_lists/open_list_factory.h"
 
+#include "../kstar/checkpoint.h"
+
+#include <limits>
+
 using namespace std;
 
 namespace top_k_eager_search {
@@ -26,7 +31,12 @@ TopKEagerSearch::TopKEagerSearch(const Options &opts)
       f_evaluator(opts.get<ScalarEvaluator *>("f_eval", nullptr)),
       preferred_operator_heuristics(opts.get_list<Heuristic *>("preferred")),
       pruning_method(opts.get<shared_ptr<PruningMethod>>("pruning")),
+      plan_constraints(opts),
       interrupted(false),
+      saps(&state_registry, &search_space),
+      tree_heap_nodes(saps),
+      tree_heap_epoch(0),
+      tree_heap_reset(-1),
       most_expensive_successor(-1),
       next_node_f(-1),
       first_plan_found(false),
@@ -43,6 +53,23 @@ TopKEagerSearch::TopKEagerSearch(const Options &opts)
     */
 }
 
+// Set g_min_action_cost and g_max_action_cost for the current costs
+static void update_action_cost_bounds() {
+    g_min_action_cost = numeric_limits<int>::max();
+    g_max_action_cost = 0;
+    for (const GlobalOperator &op : g_operators) {
+        g_min_action_cost = min(g_min_action_cost, op.get_cost());
+        g_max_action_cost = max(g_max_action_cost, op.get_cost());
+    }
+}
+
+TopKEagerSearch::~TopKEagerSearch() {
+    for (const pair<int, int> &op_cost : original_costs)
+        g_operators[op_cost.first].set_cost(op_cost.second);
+    if (!original_costs.empty())
+        update_action_cost_bounds();
+}
+
 void TopKEagerSearch::initialize() {
     cout << "Conducting best first search"
          << (reopen_closed_nodes ? " with" : " without")
@@ -67,6 +94,7 @@ void TopKEagerSearch::initialize() {
 
     heuristics.assign(hset.begin(), hset.end());
     assert(!heuristics.empty());
+    known_out_ops.assign(g_operators.size(), false);
 
     const GlobalState &initial_state = state_registry.get_initial_state();
     for (Heuristic *heuristic : heuristics) {
@@ -190,7 +218,7 @@ SearchStatus TopKEagerSearch::step() {
 
         int optimal_solution_cost = node.get_real_g() - 1;
         cout << "First plan of cost " << optimal_solution_cost << " is found";
-        if (quality_bound < 1.0) {
+        if (quality_bound < 1.0 || !prune_by_quality_bound) {
             cout << endl;
         } else {
             // Updating the search cost bound
@@ -225,6 +253,8 @@ SearchStatus TopKEagerSearch::step() {
       considered by the preferred operator queues even when it is pruned.
     */
     pruning_method->prune_operators(s, applicable_ops);
+    // Edges with forbidden operators are neither generated nor recorded
+    plan_constraints.remove_forbidden(applicable_ops);
 
     // This evaluates the expanded state (again) to get preferred ops
     EvaluationContext eval_context(s, node.get_g(), false, &statistics, true);
@@ -234,6 +264,15 @@ SearchStatus TopKEagerSearch::step() {
     int prev_f = next_node_f;
     next_node_f = eval_context.get_heuristic_value(f_evaluator);
 
+    // An edge can only be found twice if its source is expanded again
+    // after a reopening. Mark the operators of the known edges to find
+    // these in constant time.
+    bool reexpanded = expanded_before[s];
+    if (reexpanded) {
+        for (Sap sap : outgoing_edges[s])
+            known_out_ops[saps[sap].op_index] = true;
+    }
+
     bool added_goal_successor = false;
     for (const GlobalOperator *op : applicable_ops) {
         if ((node.get_real_g() + op->get_cost()) >= bound) {
@@ -299,6 +338,7 @@ SearchStatus TopKEagerSearch::step() {
                 continue;
             }
             succ_node.open(node, op);
+            invalidate_deltas(succ_state);
             if (verbosity >= kstar::Verbosity::NORMAL) {
                 if (test_goal(succ_state)) {
                     cout << "[TKES] Adding the goal successor node to the open list" << endl;
@@ -330,7 +370,14 @@ SearchStatus TopKEagerSearch::step() {
                     */
                     statistics.inc_reopened();
                 }
+                // Deltas in the memoized tree heaps can only change if
+                // the state was part of one, which requires that it was
+                // closed before.
+                bool expanded = succ_node.is_closed();
+                if (expanded || tree_heap[succ_state].built != -1)
+                    notify_g_change();
                 succ_node.reopen(node, op);
+                invalidate_deltas(succ_state);
 
                 EvaluationContext eval_context(
                         succ_state, succ_node.get_g(), is_preferred, &statistics);
@@ -358,7 +405,9 @@ SearchStatus TopKEagerSearch::step() {
                 // If we do not reopen closed nodes, we just update the parent pointers.
                 // Note that this could cause an incompatibility between
                 // the g-value and the actual path that is traced back.
+                notify_g_change();
                 succ_node.update_parent(node, op);
+                invalidate_deltas(succ_state);
             }
 
         } else {
@@ -369,6 +418,11 @@ SearchStatus TopKEagerSearch::step() {
             }
         }
     }
+    if (reexpanded) {
+        for (Sap sap : outgoing_edges[s])
+            known_out_ops[saps[sap].op_index] = false;
+    }
+    expanded_before[s] = true;
     if (verbosity >= kstar::Verbosity::NORMAL) {
         if (added_goal_successor) {
             cout << "====> [TKES] At least one goal successor was added to the open list, continuing." << endl;
@@ -396,90 +450,180 @@ void TopKEagerSearch::interrupt() {
 void TopKEagerSearch::add_incoming_edge(SearchNode node,
                                          const GlobalOperator *op,
                                          SearchNode succ_node) {
-    auto sap = make_shared<StateActionPair>(node.get_state_id(),
-            succ_node.get_state_id(),
-            op, &state_registry,
-            &search_space);
     GlobalState succ_state = succ_node.get_state();
-
-    bool duplicate =
-            std::find_if(incomming_heap[succ_state].begin(),
-                    incomming_heap[succ_state].end(),
-                    [=](const shared_ptr<StateActionPair>& other) {return *other == *sap;})
-            != incomming_heap[succ_state].end();
-
-    if (duplicate)
+    StateID from = node.get_state_id();
+    StateID to = succ_node.get_state_id();
+    int op_index = op->get_index();
+    // The edge is in the heap already (see step)
+    if (known_out_ops[op_index])
         return;
-
-    incomming_heap[succ_state].push_back(sap);
-    std::stable_sort(incomming_heap[succ_state].begin(), incomming_heap[succ_state].end(),Cmp<Sap>());
+    vector<Sap> &in_heap = incomming_heap[succ_state];
+
+    // The edge is sorted into the heap when the heap is needed (see
+    // sort_in_heap). The first edge of a generation always becomes the
+    // top of its heap segment.
+    if (in_heap.empty() || saps[in_heap.back()].generation != tree_heap_epoch)
+        notify_in_heap_change(succ_state);
+    Sap sap = saps.add(from, to, op_index, tree_heap_epoch);
+    in_heap.push_back(sap);
+    outgoing_edges[node.get_state()].push_back(sap);
     //++num_saps;
 }
 
-// Recursively trace the search path to state and add all top elements
-// of incoming heaps
+// Sort the edges added to the incoming heap of s since it was last
+// sorted. Edges are added in the order of their generation, so only the
+// generations of the new edges have to be reordered. These may be
+// several generations, which have to stay separated.
+void TopKEagerSearch::sort_in_heap(const GlobalState &s) {
+    vector<Sap> &in_heap = incomming_heap[s];
+    size_t &sorted_size = in_heap_sorted_size[s];
+    if (sorted_size == in_heap.size())
+        return;
+    size_t begin = kstar::get_generation_range(
+        in_heap, saps[in_heap[sorted_size]].generation, saps).first;
+    std::stable_sort(in_heap.begin() + begin, in_heap.end(), GenerationCmp(saps));
+    sorted_size = in_heap.size();
+}
+
+// Build H_T(state) by inserting the tops of the incoming heap of each
+// state on the search path into the (persistent) heap of its parent.
+// Heaps that are still up to date from a previous Dijkstra run are
+// reused, so only the part of the path that changed is rebuilt.
 void TopKEagerSearch::init_tree_heap(GlobalState& state) {
     if (verbosity >= kstar::Verbosity::VERBOSE) {
         cout << "[TKES] Initializing tree heap for state " << state.get_id() << endl;
     }
-    StateID parent_id = search_space.search_node_infos[state].parent_state_id;
-    if (verbosity >= kstar::Verbosity::VERBOSE) {
-       cout << "[TKES] Parent state " << parent_id << endl;
-    }
-    tree_heap[state].clear();
-    if (parent_id != StateID::no_state) {
-        GlobalState parent_state = state_registry.lookup_state(parent_id);
-        init_tree_heap(parent_state);
-        tree_heap[state].insert(tree_heap[state].end(),
-                tree_heap[parent_state].begin(),
-                tree_heap[parent_state].end());
+    // Collect the states on the search path that were not validated
+    // in this epoch yet, from state upwards.
+    vector<StateID> path;
+    StateID id = state.get_id();
+    while (id != StateID::no_state) {
+        GlobalState s = state_registry.lookup_state(id);
+        if (tree_heap[s].validated == tree_heap_epoch)
+            break;
+        path.push_back(id);
+        id = search_space.get_node_info(s).parent_state_id;
     }
-    if (verbosity >= kstar::Verbosity::VERBOSE) {
-        cout << "[TKES] Incoming heap for state " << state.get_id() << " is" << endl;
-        dump_incoming_heap(state);
+
+    int parent_root = kstar::TreeHeap::NONE;
+    int parent_built = -1;
+    if (id != StateID::no_state) {
+        const kstar::TreeHeapEntry &parent_entry =
+            tree_heap[state_registry.lookup_state(id)];
+        parent_root = parent_entry.root;
+        parent_built = parent_entry.built;
     }
-    // Copy root_in[state] to tree_heap[heap]
-    if (!incomming_heap[state].empty()) {
-        if (verbosity >= kstar::Verbosity::VERBOSE) {
-            cout << "[TKES] Pushing into tree heap" << endl;
+
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        GlobalState s = state_registry.lookup_state(*it);
+        kstar::TreeHeapEntry &entry = tree_heap[s];
+        bool up_to_date = entry.built > entry.changed
+                          && entry.built > tree_heap_reset
+                          && entry.built >= parent_built;
+        if (!up_to_date) {
+            // Insert root_in[s] of every generation into H_T(parent(s))
+            sort_in_heap(s);
+            const vector<Sap> &in_heap = incomming_heap[s];
+            entry.root = parent_root;
+            for (size_t i = 0; i < in_heap.size(); ++i) {
+                if (i == 0 || saps[in_heap[i]].generation != saps[in_heap[i - 1]].generation)
+                    entry.root = tree_heap_nodes.insert(entry.root, in_heap[i]);
+            }
+            entry.built = tree_heap_epoch;
         }
-        Sap &p = incomming_heap[state].front();
-        tree_heap[state].push_back(p);
+        entry.validated = tree_heap_epoch;
+        parent_root = entry.root;
+        parent_built = entry.built;
     }
-    std::stable_sort(tree_heap[state].begin(), tree_heap[state].end(), Cmp<Sap>());
     if (verbosity >= kstar::Verbosity::VERBOSE) {
         cout << "[TKES] Tree heap for state " << state.get_id() << " is" << endl;
         dump_tree_heap(state);
     }
 }
 
+// Build the tree heap of state that contains only edges of the given
+// generation and return its root.
+int TopKEagerSearch::init_generation_heap(GlobalState& state, int generation) {
+    vector<StateID> path;
+    StateID id = state.get_id();
+    while (id != StateID::no_state) {
+        GlobalState s = state_registry.lookup_state(id);
+        if (tree_heap[s].generation == generation)
+            break;
+        path.push_back(id);
+        id = search_space.get_node_info(s).parent_state_id;
+    }
+
+    int root = kstar::TreeHeap::NONE;
+    if (id != StateID::no_state)
+        root = tree_heap[state_registry.lookup_state(id)].generation_root;
+
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        GlobalState s = state_registry.lookup_state(*it);
+        sort_in_heap(s);
+        const vector<Sap> &in_heap = incomming_heap[s];
+        pair<size_t, size_t> range = kstar::get_generation_range(in_heap, generation, saps);
+        if (range.first != range.second)
+            root = tree_heap_nodes.insert(root, in_heap[range.first]);
+        kstar::TreeHeapEntry &entry = tree_heap[s];
+        entry.generation = generation;
+        entry.generation_root = root;
+    }
+    return root;
+}
+
+// The g-value of s changed. This changes the deltas of all edges into s
+// and, if s was expanded before, of the edges out of s. A reopened state
+// keeps its outgoing edges until it is expanded again.
+void TopKEagerSearch::invalidate_deltas(const GlobalState &s) {
+    for (Sap sap : incomming_heap[s])
+        saps.invalidate_delta(sap);
+    for (Sap sap : outgoing_edges[s])
+        saps.invalidate_delta(sap);
+}
+
+// The top of the incoming heap of s changed, so H_T(s) and the tree
+// heaps of all states below s have to be rebuilt.
+void TopKEagerSearch::notify_in_heap_change(const GlobalState &s) {
+    tree_heap[s].changed = tree_heap_epoch;
+}
+
+// A g-value or parent pointer is about to change, which can change the
+// deltas of edges anywhere in the memoized tree heaps.
+void TopKEagerSearch::notify_g_change() {
+    tree_heap_reset = tree_heap_epoch;
+}
+
 void TopKEagerSearch::dump_incoming_heap(const GlobalState& s) const {
     for (Sap sap: incomming_heap[s]) {
-        cout << sap->get_from_state().get_id() << "  ->  " << sap->get_to_state().get_id();
-        cout <<" [ " << sap->op->get_name();
-        cout << "/"<< sap->op->get_cost() << "]" << endl;
+        cout << saps[sap].from << "  ->  " << saps[sap].to;
+        cout <<" [ " << saps.get_op(sap)->get_name();
+        cout << "/"<< saps.get_op(sap)->get_cost() << "]" << endl;
     }
 }
 void TopKEagerSearch::dump_tree_heap(const GlobalState& s) const {
-    for (Sap sap: tree_heap[s]) {
-        cout << sap->get_from_state().get_id() << "  ->  " << sap->get_to_state().get_id();
-        cout <<" [ " << sap->op->get_name();
-        cout << "/"<< sap->op->get_cost() << "]" << endl;
+    vector<int> heap_nodes;
+    tree_heap_nodes.get_nodes(tree_heap[s].root, heap_nodes);
+    for (int heap_node : heap_nodes) {
+        Sap sap = tree_heap_nodes[heap_node].sap;
+        cout << saps[sap].from << "  ->  " << saps[sap].to;
+        cout <<" [ " << saps.get_op(sap)->get_name();
+        cout << "/"<< saps.get_op(sap)->get_cost() << "]" << endl;
     }
 }
 
-std::string TopKEagerSearch::get_node_label(StateActionPair &edge) {
-    int from = state_registry.lookup_state(edge.from)[0];
-    int to = state_registry.lookup_state(edge.to)[0];
+std::string TopKEagerSearch::get_node_label(Sap edge) {
+    int from = saps.get_from_state(edge)[0];
+    int to = saps.get_to_state(edge)[0];
     std::string node_name = std::to_string(from) + std::to_string(to)
-                            + " delta: " + std::to_string(edge.get_delta());
+                            + " delta: " + std::to_string(saps.get_delta(edge));
     return node_name;
 }
 
-std::string TopKEagerSearch::get_node_name(StateActionPair &edge) {
-    string from = state_registry.lookup_state(edge.from).get_state_tuple();
-    string to = state_registry.lookup_state(edge.to).get_state_tuple();
-    std::string node_name = "(" + from +","+ to + ") " + edge.op->get_name();
+std::string TopKEagerSearch::get_node_name(Sap edge) {
+    string from = saps.get_from_state(edge).get_state_tuple();
+    string to = saps.get_to_state(edge).get_state_tuple();
+    std::string node_name = "(" + from +","+ to + ") " + saps.get_op(edge)->get_name();
     return node_name;
 }
 
@@ -493,33 +637,435 @@ std::string TopKEagerSearch::get_node_name(StateActionPair &edge) {
 
 // removing the tree edge
 void TopKEagerSearch::remove_tree_edge(GlobalState s)  {
-    SearchNodeInfo info = search_space.search_node_infos[s];
-    int creating_op_index = g_operators[info.creating_operator].get_index();
+    const SearchNodeInfo &info = search_space.get_node_info(s);
+    // -1 for the initial state, which has no tree edge
+    int creating_op_index = info.creating_operator;
     StateID parent_state_id = info.parent_state_id;
     int tree_edge_pos = -1;
 
     for (size_t i = 0; i < incomming_heap[s].size(); ++i) {
         Sap sap = incomming_heap[s][i];
-        if (sap->get_delta() > 0)
+        if (saps.get_delta(sap) > 0)
             continue;
-        if(sap->op->get_index() == creating_op_index
-           && parent_state_id == sap->from) {
+        if(saps[sap].op_index == creating_op_index
+           && parent_state_id == saps[sap].from) {
             tree_edge_pos = i;
             break;
         }
     }
 
     if (tree_edge_pos != -1) {
+        remove_outgoing_edge(incomming_heap[s][tree_edge_pos]);
         incomming_heap[s].erase(incomming_heap[s].begin() + tree_edge_pos);
     }
 }
 
+// The edge was removed from the incoming heap of its target
+void TopKEagerSearch::remove_outgoing_edge(Sap sap) {
+    vector<Sap> &out = outgoing_edges[saps.get_from_state(sap)];
+    auto it = find(out.begin(), out.end(), sap);
+    assert(it != out.end());
+    *it = out.back();
+    out.pop_back();
+}
 
-// Sort the incoming heap edges according to their delta
+// The edge from the given state via the operator that is in the incoming
+// heap of its target, -1 if there is none
+Sap TopKEagerSearch::find_outgoing_edge(StateID from, int op_index) {
+    for (Sap sap : outgoing_edges[state_registry.lookup_state(from)]) {
+        if (saps[sap].op_index == op_index)
+            return sap;
+    }
+    return -1;
+}
+
+
+// Sort the incoming heap edges according to their generation and delta
 // value and remove the tree edge
 void TopKEagerSearch::sort_and_remove(GlobalState s) {
-    std::stable_sort(incomming_heap[s].begin(), incomming_heap[s].end(), Cmp<Sap>());
+    std::stable_sort(incomming_heap[s].begin(), incomming_heap[s].end(), GenerationCmp(saps));
     remove_tree_edge(s);
+    in_heap_sorted_size[s] = incomming_heap[s].size();
+    notify_in_heap_change(s);
+}
+
+int TopKEagerSearch::get_original_cost(int op_index) const {
+    for (const pair<int, int> &op_cost : original_costs) {
+        if (op_cost.first == op_index)
+            return op_cost.second;
+    }
+    return g_operators[op_index].get_cost();
+}
+
+/*
+  Change the costs of operators, given as pairs of operator index and
+  cost, and repair the search for the new costs instead of starting it
+  again. No state is expanded again: the recorded edges already contain
+  the successors of all expanded states. Returns whether a cost changed.
+
+  The heuristics are not rebuilt, so heuristics that precompute from the
+  operator costs keep the original ones. They stay admissible as long as
+  no cost is below its original cost, which the caller has to ensure.
+*/
+bool TopKEagerSearch::change_operator_costs(const vector<pair<int, int>> &new_costs) {
+    vector<int> old_costs(g_operators.size(), -1);
+    for (const pair<int, int> &op_cost : new_costs) {
+        GlobalOperator &op = g_operators[op_cost.first];
+        if (old_costs[op_cost.first] == -1) {
+            old_costs[op_cost.first] = op.get_cost();
+            bool changed_before =
+                find_if(original_costs.begin(), original_costs.end(),
+                        [&](const pair<int, int> &original) {
+                            return original.first == op_cost.first;
+                        }) != original_costs.end();
+            if (!changed_before)
+                original_costs.emplace_back(op_cost.first, op.get_cost());
+        }
+        op.set_cost(op_cost.second);
+    }
+    int num_changed = 0;
+    for (size_t op_index = 0; op_index < old_costs.size(); ++op_index) {
+        if (old_costs[op_index] == g_operators[op_index].get_cost())
+            old_costs[op_index] = -1;
+        else if (old_costs[op_index] != -1)
+            ++num_changed;
+    }
+    if (num_changed == 0)
+        return false;
+    update_action_cost_bounds();
+    int num_repaired = repair_g_values(old_costs);
+    reopen_search();
+    cout << "Changed the costs of " << num_changed << " operators, repaired the"
+         << " g-values of " << num_repaired << " states" << endl;
+    return true;
+}
+
+/*
+  Repair the g-values and the shortest path tree over the recorded edges
+  after the costs of some operators changed (old_costs holds the former
+  cost of each changed operator and -1 for the others). As in dynamic
+  shortest path algorithms, the states whose tree edge became more
+  expensive lose their g-values, together with their subtrees, and a
+  Dijkstra search from the edges into them and from the edges that became
+  cheaper computes the new g-values. Only the states that this search
+  reaches and the incoming heaps whose deltas changed are touched.
+  Returns the number of states whose g-value or parent changed.
+*/
+int TopKEagerSearch::repair_g_values(const vector<int> &old_costs) {
+    PerStateInformation<SearchNodeInfo> &search_node_infos =
+        search_space.search_node_infos;
+    int num_states = state_registry.size();
+    vector<StateID> ids(num_states, StateID::no_state);
+    // g-value, parent and creating operator of the states reached by the
+    // search, g is -1 for the others
+    vector<int> g(num_states, -1);
+    vector<int> parent(num_states, -1);
+    vector<int> creating_op(num_states, -1);
+    // Recorded edges (target, operator) out of each state
+    vector<vector<pair<int, int>>> successors(num_states);
+    for (PerStateInformation<SearchNodeInfo>::const_iterator it =
+             search_node_infos.begin(&state_registry);
+         it != search_node_infos.end(&state_registry); ++it) {
+        GlobalState s = state_registry.lookup_state(*it);
+        const SearchNodeInfo &info = search_node_infos[s];
+        int id = (*it).get_value();
+        ids[id] = *it;
+        if (info.status != SearchNodeInfo::OPEN &&
+            info.status != SearchNodeInfo::CLOSED)
+            continue;
+        g[id] = info.g;
+        creating_op[id] = info.creating_operator;
+        if (info.parent_state_id != StateID::no_state)
+            parent[id] = info.parent_state_id.get_value();
+        // The tree edge is removed from the heap once s is expanded
+        bool tree_edge_in_heap = false;
+        for (Sap sap : incomming_heap[s]) {
+            const StateActionPair &edge = saps[sap];
+            if (edge.from == info.parent_state_id &&
+                edge.op_index == info.creating_operator)
+                tree_edge_in_heap = true;
+            successors[edge.from.get_value()].emplace_back(id, edge.op_index);
+        }
+        if (parent[id] != -1 && !tree_edge_in_heap)
+            successors[parent[id]].emplace_back(id, info.creating_operator);
+    }
+    vector<int> old_parent(parent);
+    vector<int> old_creating_op(creating_op);
+
+    // Subtrees below the tree edges that became more expensive
+    const int infinity = numeric_limits<int>::max();
+    vector<bool> raised(num_states, false);
+    vector<int> stack;
+    for (int id = 0; id < num_states; ++id) {
+        if (parent[id] == -1 || old_costs[creating_op[id]] == -1)
+            continue;
+        if (old_costs[creating_op[id]] < g_operators[creating_op[id]].get_cost())
+            stack.push_back(id);
+    }
+    while (!stack.empty()) {
+        int id = stack.back();
+        stack.pop_back();
+        if (raised[id])
+            continue;
+        raised[id] = true;
+        g[id] = infinity;
+        for (const pair<int, int> &succ : successors[id]) {
+            if (parent[succ.first] == id && creating_op[succ.first] == succ.second)
+                stack.push_back(succ.first);
+        }
+    }
+
+    priority_queues::AdaptiveQueue<int> queue;
+    auto relax = [&](int from, int to, int op_index) {
+        int new_g = g[from] + get_adjusted_cost(g_operators[op_index]);
+        if (new_g < g[to]) {
+            g[to] = new_g;
+            parent[to] = from;
+            creating_op[to] = op_index;
+            queue.push(new_g, to);
+        }
+    };
+    // The deltas of the edges of changed operators change in any case
+    vector<bool> resort(num_states, false);
+    for (int id = 0; id < num_states; ++id) {
+        if (g[id] == -1)
+            continue;
+        for (const pair<int, int> &succ : successors[id]) {
+            bool changed_op = old_costs[succ.second] != -1;
+            if (changed_op)
+                resort[succ.first] = true;
+            if (!raised[id] && (changed_op || raised[succ.first]))
+                relax(id, succ.first, succ.second);
+        }
+    }
+
+    vector<int> repaired;
+    while (!queue.empty()) {
+        pair<int, int> entry = queue.pop();
+        int id = entry.second;
+        if (entry.first != g[id])
+            continue;
+        // A state is popped again only after its parent got a smaller
+        // g-value, so the real g-value of the parent is final here.
+        SearchNodeInfo &info = search_node_infos[state_registry.lookup_state(ids[id])];
+        const SearchNodeInfo &parent_info =
+            search_node_infos[state_registry.lookup_state(ids[parent[id]])];
+        if (info.g != g[id] || info.parent_state_id != ids[parent[id]]
+            || info.creating_operator != creating_op[id])
+            repaired.push_back(id);
+        info.g = g[id];
+        info.real_g = parent_info.real_g + g_operators[creating_op[id]].get_cost();
+        info.parent_state_id = ids[parent[id]];
+        info.creating_operator = creating_op[id];
+        resort[id] = true;
+        for (const pair<int, int> &succ : successors[id]) {
+            resort[succ.first] = true;
+            relax(id, succ.first, succ.second);
+        }
+    }
+    sort(repaired.begin(), repaired.end());
+    repaired.erase(unique(repaired.begin(), repaired.end()), repaired.end());
+
+    for (int id : repaired) {
+        assert(g[id] != infinity);
+        if (parent[id] == old_parent[id] && creating_op[id] == old_creating_op[id])
+            continue;
+        // The former tree edge is an ordinary incoming edge now. If the
+        // state was expanded, it was removed from the heap and the new
+        // tree edge has to be removed instead. Edges are looked up among
+        // the outgoing edges of their source, since incoming heaps can be
+        // much larger.
+        if (find_outgoing_edge(ids[old_parent[id]], old_creating_op[id]) == -1) {
+            vector<Sap> &in_heap = incomming_heap[state_registry.lookup_state(ids[id])];
+            Sap tree_edge = find_outgoing_edge(ids[parent[id]], creating_op[id]);
+            if (tree_edge != -1) {
+                remove_outgoing_edge(tree_edge);
+                in_heap.erase(find(in_heap.begin(), in_heap.end(), tree_edge));
+            }
+            Sap sap = saps.add(ids[old_parent[id]], ids[id],
+                               old_creating_op[id], tree_heap_epoch);
+            in_heap.push_back(sap);
+            outgoing_edges[state_registry.lookup_state(ids[old_parent[id]])].push_back(sap);
+        }
+    }
+
+    saps.invalidate_all_deltas();
+    for (int id = 0; id < num_states; ++id) {
+        if (!resort[id])
+            continue;
+        GlobalState s = state_registry.lookup_state(ids[id]);
+        vector<Sap> &in_heap = incomming_heap[s];
+        stable_sort(in_heap.begin(), in_heap.end(), GenerationCmp(saps));
+        in_heap_sorted_size[s] = in_heap.size();
+        notify_in_heap_change(s);
+    }
+    // Not notify_g_change: the tree changed already, and everything that
+    // depends on the old costs is dropped anyway
+    tree_heap_reset = tree_heap_epoch;
+    return repaired.size();
+}
+
+// Evaluate the open states again, since their g-values or the heuristic
+// values for the new operator costs may have changed, and let A* find the
+// goal state again before plans are reconstructed.
+void TopKEagerSearch::reopen_search() {
+    if (goal_state != StateID::no_state) {
+        SearchNode goal_node =
+            search_space.get_node(state_registry.lookup_state(goal_state));
+        if (goal_node.is_closed())
+            goal_node.unclose();
+        goal_state = StateID::no_state;
+    }
+    first_plan_found = false;
+    open_list->clear();
+    next_node_f = numeric_limits<int>::max();
+    for (PerStateInformation<SearchNodeInfo>::const_iterator it =
+             search_space.search_node_infos.begin(&state_registry);
+         it != search_space.search_node_infos.end(&state_registry); ++it) {
+        GlobalState s = state_registry.lookup_state(*it);
+        SearchNode node = search_space.get_node(s);
+        if (!node.is_open())
+            continue;
+        // Computing preferred operators bypasses the cached heuristic
+        // values, which were computed for the old costs
+        EvaluationContext eval_context(s, node.get_g(), true, &statistics, true);
+        statistics.inc_evaluated_states();
+        open_list->insert(eval_context, s.get_id());
+        if (f_evaluator)
+            next_node_f = min(next_node_f, eval_context.get_heuristic_value(f_evaluator));
+    }
+    all_nodes_expanded = open_list->empty();
+}
+
+/*
+  Write the state of A* and the edges it found to a checkpoint: the
+  packed states, the search node infos, the edge arena, the incoming
+  heaps and the tree heaps, mostly in bulk. The open list is not
+  written, since it can be rebuilt from the open states.
+*/
+void TopKEagerSearch::write_checkpoint(ostream &out) const {
+    kstar::write_value(out, bound);
+    kstar::write_value(out, statistics);
+    kstar::write_value(out, number_of_plans);
+    kstar::write_value(out, quality_bound);
+    kstar::write_value(out, goal_state);
+    kstar::write_value(out, first_plan_found);
+    kstar::write_value(out, all_nodes_expanded);
+    kstar::write_value(out, next_node_f);
+    kstar::write_value(out, interrupted);
+    kstar::write_value(out, tree_heap_epoch);
+    kstar::write_value(out, tree_heap_reset);
+    kstar::write_value(out, most_expensive_successor);
+    kstar::write_value(out, static_cast<int>(original_costs.size()));
+    for (const pair<int, int> &op_cost : original_costs) {
+        kstar::write_value(out, op_cost.first);
+        kstar::write_value(out, op_cost.second);
+        kstar::write_value(out, g_operators[op_cost.first].get_cost());
+    }
+
+    state_registry.write_states(out);
+    search_space.search_node_infos.write_entries(&state_registry, out);
+    saps.write(out);
+    // Sizes of all incoming heaps first, then their edges
+    vector<int32_t> heap_sizes;
+    heap_sizes.reserve(state_registry.size());
+    for (PerStateInformation<vector<Sap>>::const_iterator it =
+             incomming_heap.begin(&state_registry);
+         it != incomming_heap.end(&state_registry); ++it)
+        heap_sizes.push_back(incomming_heap[state_registry.lookup_state(*it)].size());
+    out.write(reinterpret_cast<const char *>(heap_sizes.data()),
+              heap_sizes.size() * sizeof(int32_t));
+    for (PerStateInformation<vector<Sap>>::const_iterator it =
+             incomming_heap.begin(&state_registry);
+         it != incomming_heap.end(&state_registry); ++it) {
+        const vector<Sap> &in_heap = incomming_heap[state_registry.lookup_state(*it)];
+        out.write(reinterpret_cast<const char *>(in_heap.data()),
+                  in_heap.size() * sizeof(Sap));
+    }
+    in_heap_sorted_size.write_entries(&state_registry, out);
+    expanded_before.write_entries(&state_registry, out);
+    tree_heap_nodes.write(out);
+    tree_heap.write_entries(&state_registry, out);
+}
+
+/*
+  Restore the state written by write_checkpoint after initialize, which
+  registered the initial state, and rebuild the open list. The open
+  states are evaluated again. Returns false if the checkpoint does not
+  fit the task or is truncated.
+*/
+bool TopKEagerSearch::read_checkpoint(istream &in) {
+    int num_changed_costs;
+    if (!kstar::read_value(in, bound) ||
+        !kstar::read_value(in, statistics) ||
+        !kstar::read_value(in, number_of_plans) ||
+        !kstar::read_value(in, quality_bound) ||
+        !kstar::read_value(in, goal_state) ||
+        !kstar::read_value(in, first_plan_found) ||
+        !kstar::read_value(in, all_nodes_expanded) ||
+        !kstar::read_value(in, next_node_f) ||
+        !kstar::read_value(in, interrupted) ||
+        !kstar::read_value(in, tree_heap_epoch) ||
+        !kstar::read_value(in, tree_heap_reset) ||
+        !kstar::read_value(in, most_expensive_successor) ||
+        !kstar::read_value(in, num_changed_costs) || num_changed_costs < 0)
+        return false;
+    for (int i = 0; i < num_changed_costs; ++i) {
+        int op_index, original_cost, cost;
+        if (!kstar::read_value(in, op_index) ||
+            !kstar::read_value(in, original_cost) ||
+            !kstar::read_value(in, cost) ||
+            op_index < 0 || op_index >= static_cast<int>(g_operators.size()))
+            return false;
+        original_costs.emplace_back(op_index, original_cost);
+        g_operators[op_index].set_cost(cost);
+    }
+    if (num_changed_costs > 0)
+        update_action_cost_bounds();
+
+    if (!state_registry.read_states(in) ||
+        !search_space.search_node_infos.read_entries(&state_registry, in) ||
+        !saps.read(in))
+        return false;
+    vector<int32_t> heap_sizes(state_registry.size());
+    if (!in.read(reinterpret_cast<char *>(heap_sizes.data()),
+                 heap_sizes.size() * sizeof(int32_t)))
+        return false;
+    for (PerStateInformation<vector<Sap>>::const_iterator it =
+             incomming_heap.begin(&state_registry);
+         it != incomming_heap.end(&state_registry); ++it) {
+        vector<Sap> &in_heap = incomming_heap[state_registry.lookup_state(*it)];
+        in_heap.resize(heap_sizes[(*it).get_value()]);
+        if (!in.read(reinterpret_cast<char *>(in_heap.data()),
+                     in_heap.size() * sizeof(Sap)))
+            return false;
+    }
+    if (!in_heap_sorted_size.read_entries(&state_registry, in) ||
+        !expanded_before.read_entries(&state_registry, in) ||
+        !tree_heap_nodes.read(in) ||
+        !tree_heap.read_entries(&state_registry, in))
+        return false;
+    // The outgoing edges are not written, they are the edges in the heaps
+    for (PerStateInformation<vector<Sap>>::const_iterator it =
+             incomming_heap.begin(&state_registry);
+         it != incomming_heap.end(&state_registry); ++it) {
+        for (Sap sap : incomming_heap[state_registry.lookup_state(*it)])
+            outgoing_edges[saps.get_from_state(sap)].push_back(sap);
+    }
+
+    open_list->clear();
+    for (PerStateInformation<SearchNodeInfo>::const_iterator it =
+             search_space.search_node_infos.begin(&state_registry);
+         it != search_space.search_node_infos.end(&state_registry); ++it) {
+        GlobalState s = state_registry.lookup_state(*it);
+        SearchNode node = search_space.get_node(s);
+        if (!node.is_open())
+            continue;
+        EvaluationContext eval_context(s, node.get_g(), true, &statistics);
+        statistics.inc_evaluated_states();
+        open_list->insert(eval_context, s.get_id());
+    }
+    return true;
 }
 
 pair<SearchNode, bool> TopKEagerSearch::fetch_next_node() {
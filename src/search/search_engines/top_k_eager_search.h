@@ -8,6 +8,8 @@
 #include "../utils/util.h"
 
 #include "../kstar/kstar_types.h"
+#include "../kstar/plan_constraints.h"
+#include "../kstar/tree_heap.h"
 
 #include <memory>
 #include <algorithm>
@@ -24,25 +26,51 @@ class Options;
 }
 
 namespace top_k_eager_search {
-typedef shared_ptr<StateActionPair> Sap;
+using kstar::Sap;
 
 class TopKEagerSearch : public SearchEngine {
     const bool reopen_closed_nodes;
 protected:
-    const int number_of_plans;
-    const double quality_bound;
+    int number_of_plans;
+    double quality_bound;
+    // Whether the quality bound becomes the cost bound of A* once the
+    // first plan is found. This prunes states for good, so K* keeps them
+    // when the quality bound can be raised later.
+    bool prune_by_quality_bound = true;
     std::unique_ptr<StateOpenList> open_list;
     ScalarEvaluator *f_evaluator;
     std::vector<Heuristic *> heuristics;
     std::vector<Heuristic *> preferred_operator_heuristics;
     std::shared_ptr<PruningMethod> pruning_method;
+    kstar::PlanConstraints plan_constraints;
     bool interrupted;
     StateID goal_state = StateID::no_state;
     bool all_nodes_expanded = false;
     int counter = 0;
     // std::vector<kstar::StateSequence> top_k_plans_states;
+    // All edges found by A*, referred to by index from the heaps
+    SapArena saps;
     PerStateInformation<vector<Sap>> incomming_heap;
-    PerStateInformation<vector<Sap>> tree_heap;
+    // Incoming heaps are sorted lazily: length of the sorted prefix
+    PerStateInformation<size_t> in_heap_sorted_size;
+    // States that were expanded before and may have outgoing edges already
+    PerStateInformation<bool> expanded_before;
+    // Edges out of each state that are in an incoming heap
+    PerStateInformation<vector<Sap>> outgoing_edges;
+    // Operators of the known edges out of the state that is expanded
+    // (indexed by operator)
+    std::vector<bool> known_out_ops;
+    // Persistent tree heaps H_T(s), memoized across Dijkstra runs
+    kstar::TreeHeap tree_heap_nodes;
+    PerStateInformation<kstar::TreeHeapEntry> tree_heap;
+    // Incremented by K* for each Dijkstra run. Edges found by A* are
+    // labeled with the epoch as their generation.
+    int tree_heap_epoch;
+    // Tree heaps built before this epoch are invalid (g-values changed)
+    int tree_heap_reset;
+    // Operators whose costs were changed and their original costs, which
+    // are restored when the search is destroyed
+    std::vector<std::pair<int, int>> original_costs;
 
     // g-value of the most expensive successor of the current
     // top node of the djkstra queue
@@ -68,16 +96,32 @@ protected:
     void dump_incoming_heap(const GlobalState& s) const;
     void dump_tree_heap(const GlobalState& s) const;
 
+    void invalidate_deltas(const GlobalState &s);
+    void notify_in_heap_change(const GlobalState &s);
+    // Called before the shortest path tree changes
+    virtual void notify_g_change();
+    void sort_in_heap(const GlobalState &s);
     void remove_tree_edge(GlobalState s);
+    void remove_outgoing_edge(Sap sap);
+    Sap find_outgoing_edge(StateID from, int op_index);
     void sort_and_remove(GlobalState  s);
-    std::string get_node_label(StateActionPair &edge);
-    std::string get_node_name(StateActionPair &edge);
+    // Cost of the operator when the search started, which the
+    // heuristics were built with
+    int get_original_cost(int op_index) const;
+    bool change_operator_costs(const std::vector<std::pair<int, int>> &new_costs);
+    int repair_g_values(const std::vector<int> &old_costs);
+    void reopen_search();
+    void write_checkpoint(std::ostream &out) const;
+    bool read_checkpoint(std::istream &in);
+    std::string get_node_label(Sap edge);
+    std::string get_node_name(Sap edge);
 
 public:
     explicit TopKEagerSearch(const options::Options &opts);
-    virtual ~TopKEagerSearch() = default;
+    virtual ~TopKEagerSearch();
     virtual void print_statistics() const override;
     void init_tree_heap(GlobalState& state);
+    int init_generation_heap(GlobalState& state, int generation);
 };
 
 void add_top_k_option(OptionParser &parser);
@@ -5,6 +5,8 @@
 #include "globals.h"
 #include "successor_generator.h"
 
+#include "utils/json.h"
+
 #include <cassert>
 #include <sstream>
 #include "search_node_info.h"
@@ -135,6 +137,10 @@ SearchNode SearchSpace::get_node(const GlobalState &state) {
         state_registry, state.get_id(), search_node_infos[state], cost_type);
 }
 
+const SearchNodeInfo &SearchSpace::get_node_info(const GlobalState &state) const {
+    return search_node_infos[state];
+}
+
 void SearchSpace::trace_path(const GlobalState &goal_state,
                              vector<const GlobalOperator *> &path) const {
     GlobalState current_state = goal_state;
@@ -171,9 +177,11 @@ void SearchSpace::dump_state(std::ostream& os, const GlobalState& state) const {
     os << "[" << endl;
     size_t i = 0;
     for (; i < names.size() - 1; ++i) {
-        os << "\"" << names[i] << "\"," << endl;
+        utils::write_json_string(os, names[i]);
+        os << "," << endl;
     }
-    os << "\"" << names[i] << "\"" << endl;
+    utils::write_json_string(os, names[i]);
+    os << endl;
     os << "]" << endl;
 }
 
@@ -62,6 +62,9 @@ public:
     SearchSpace(StateRegistry &state_registry, OperatorCost cost_type);
 
     SearchNode get_node(const GlobalState &state);
+    // Unlike get_node, never resizes the table of search nodes, so other
+    // threads may read it at the same time
+    const SearchNodeInfo &get_node_info(const GlobalState &state) const;
     void trace_path(const GlobalState &goal_state,
                     std::vector<const GlobalOperator *> &path) const;
 
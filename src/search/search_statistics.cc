@@ -23,6 +23,11 @@ SearchStatistics::SearchStatistics() {
 	num_opt_plans = 0;
 	num_djkstra_runs = 0;	
 	total_djkstra_node_generations = 0;
+	num_non_simple_plans = 0;
+	num_pruned_djkstra_nodes = 0;
+	num_unqualified_plans = 0;
+	num_declined_djkstra_switches = 0;
+	num_futile_djkstra_runs = 0;
 
     lastjump_expanded_states = 0;
     lastjump_reopened_states = 0;
@@ -82,6 +87,20 @@ void SearchStatistics::print_detailed_statistics() const {
 	cout << "Number of plans found: "<< num_plans_found << std::endl;
 	cout << "Number of optimal plans found: "<< num_opt_plans << std::endl;
 	cout << "Number of djkstra runs: "<< num_djkstra_runs << std::endl;
+	cout << "Number of djkstra runs without expansions: "
+		 << num_futile_djkstra_runs << std::endl;
+	cout << "Number of declined switches to djkstra: "
+		 << num_declined_djkstra_switches << std::endl;
 	cout << "Total number of djkstra node generations: " 
 			  << total_djkstra_node_generations << std::endl;
+	if (num_non_simple_plans > 0) {
+		cout << "Number of non-simple plans skipped: "
+			 << num_non_simple_plans << std::endl;
+		cout << "Number of pruned djkstra nodes: "
+			 << num_pruned_djkstra_nodes << std::endl;
+	}
+	if (num_unqualified_plans > 0) {
+		cout << "Number of plans skipped without a required operator: "
+			 << num_unqualified_plans << std::endl;
+	}
 }
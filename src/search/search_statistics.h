@@ -31,6 +31,11 @@ class SearchStatistics {
 	int num_opt_plans;
 	int num_djkstra_runs;	
 	int total_djkstra_node_generations;
+	int num_non_simple_plans;	// plans skipped because they revisit a state
+	int num_pruned_djkstra_nodes;	// nodes whose successors can only revisit states
+	int num_unqualified_plans;	// plans skipped because they miss a required operator
+	int num_declined_djkstra_switches;	// f-layers at which A* was not interrupted
+	int num_futile_djkstra_runs;	// djkstra runs that expanded no node
 
     void print_f_line() const;
 public:
@@ -53,6 +58,11 @@ public:
 
     void inc_djkstra_runs(int inc = 1){num_djkstra_runs += inc;};
     void inc_total_djkstra_generations(int inc = 1){total_djkstra_node_generations += inc;};
+    void inc_non_simple_plans(int inc = 1){num_non_simple_plans += inc;};
+    void inc_pruned_djkstra_nodes(int inc = 1){num_pruned_djkstra_nodes += inc;};
+    void inc_unqualified_plans(int inc = 1){num_unqualified_plans += inc;};
+    void inc_declined_djkstra_switches(int inc = 1){num_declined_djkstra_switches += inc;};
+    void inc_futile_djkstra_runs(int inc = 1){num_futile_djkstra_runs += inc;};
 
     // Methods that access statistics.
     int get_expanded() const {return expanded_states; }
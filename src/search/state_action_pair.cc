@@ -1,4 +1,42 @@
 #include "state_action_pair.h"
 #include "state_id.h"
 
+#include "globals.h"
 
+const GlobalOperator *SapArena::get_op(int sap) const {
+	int op_index = saps[sap].op_index;
+	return op_index == -1 ? nullptr : &g_operators[op_index];
+}
+
+GlobalState SapArena::get_from_state(int sap) const {
+	return reg->lookup_state(saps[sap].from);
+}
+
+GlobalState SapArena::get_to_state(int sap) const {
+	return reg->lookup_state(saps[sap].to);
+}
+
+int SapArena::compute_delta(const StateActionPair &edge) const {
+	if (edge.from == StateID::no_state)
+		return -1;
+	const SearchNodeInfo &from_info = ssp->get_node_info(reg->lookup_state(edge.from));
+	const SearchNodeInfo &to_info = ssp->get_node_info(reg->lookup_state(edge.to));
+	return from_info.g + g_operators[edge.op_index].get_cost() - to_info.g;
+}
+
+void SapArena::write(std::ostream &out) const {
+	int64_t num_saps = saps.size();
+	out.write(reinterpret_cast<const char *>(&num_saps), sizeof(num_saps));
+	out.write(reinterpret_cast<const char *>(&delta_epoch), sizeof(delta_epoch));
+	saps.write(out);
+}
+
+bool SapArena::read(std::istream &in) {
+	int64_t num_saps;
+	if (saps.size() != 0 ||
+		!in.read(reinterpret_cast<char *>(&num_saps), sizeof(num_saps)) ||
+		!in.read(reinterpret_cast<char *>(&delta_epoch), sizeof(delta_epoch)) ||
+		num_saps < 0)
+		return false;
+	return saps.read(in, num_saps);
+}
@@ -1,5 +1,5 @@
 #ifndef STATE_ACTION_PAIR
-#define STATE_ACTION_PAIR 
+#define STATE_ACTION_PAIR
 
 //#include <boost/functional/hash.hpp>
 
@@ -9,64 +9,27 @@
 #include "global_operator.h"
 #include "utils/util.h"
 #include "utils/hash.h"
+#include "algorithms/segmented_vector.h"
 
-class StateActionPair {
-public:
+#include <cstdint>
+
+// Edge (from, to) of the explored state space labeled with the operator
+// that induces it. Edges are stored in a SapArena and referred to by
+// their index there. With the cached delta, the record takes 24 bytes.
+struct StateActionPair {
 	StateID from;
 	StateID to;
-	const  GlobalOperator* op;
-	const StateRegistry* reg;
-
-	SearchSpace* ssp;
-	static const StateActionPair no_sap; 
-
-	StateActionPair(const StateActionPair& other)
-			: from(other.from), to(other.to), op(other.op), reg(other.reg), ssp(other.ssp) {
-
-	};
-
-	StateActionPair(StateID from, StateID to, const GlobalOperator* op,
-					const StateRegistry* reg, SearchSpace* ssp)
-		: from(from), to(to), op(op), reg(reg), ssp(ssp) {
-
-	};
-
-	~StateActionPair() {
-	}
-
-	GlobalState get_from_state() {
-		return reg->lookup_state(from);			
-	};
-
-	GlobalState get_to_state() {
-		return reg->lookup_state(to);			
-	};
-
-	int from_g() const {
-		const GlobalState from_state = reg->lookup_state(from);
-		SearchNode from_node = ssp->get_node(from_state);
-		return from_node.get_g();
-	};
-
-	int edge_cost() const {
-		return op->get_cost();
-	};	
-	
-	int to_g() const {
-		const GlobalState to_state = reg->lookup_state(to);
-		SearchNode to_node = ssp->get_node(to_state);
-		return to_node.get_g();
-	};
-
-	int get_delta() const {
-		if (from == StateID::no_state)
-			return -1;
-		const GlobalState to_state = reg->lookup_state(to);
-		const GlobalState from_state = reg->lookup_state(from);
-		SearchNode from_node = ssp->get_node(from_state);
-		SearchNode to_node = ssp->get_node(to_state);
-
-		return from_node.get_g() + op->get_cost() - to_node.get_g();
+	// index of the operator in g_operators, -1 for the root of the path graph
+	int op_index;
+	// Dijkstra run of K* after which the edge was found
+	int generation;
+	// Cached delta, valid if delta_epoch equals the epoch of the arena
+	mutable int delta;
+	mutable int delta_epoch;
+
+	StateActionPair(StateID from, StateID to, int op_index, int generation)
+		: from(from), to(to), op_index(op_index), generation(generation),
+		  delta(-1), delta_epoch(-1) {
 	};
 
 	size_t hash() const {
@@ -78,97 +41,118 @@ public:
 		return seed;
 	}
 
-	bool operator<(const StateActionPair &other) const {
-		if (this->get_delta() < other.get_delta())
-			return true;
-		if (this->get_delta() > other.get_delta())
-            return false;
-		if (this->hash() < other.hash())
-			return true;
-		return false;
-	};
-
 	bool operator==(const StateActionPair& other) const {
-		if (from != other.from)
-			return false;
-		if (to != other.to)
-			return false;
-		if (op->get_index() != other.op->get_index())
-			return false;
-		return true;
+		return from == other.from && to == other.to
+			&& op_index == other.op_index;
 	};
 
 	bool operator!=(const StateActionPair &other) const {
-		if (*this == other)
-			return false;
-		return true;
+		return !(*this == other);
 	}
 };
-struct Node;
+static_assert(sizeof(StateActionPair) == 24,
+              "edges are written to checkpoints in bulk");
+
+/*
+  Contiguous storage of all edges found by the search. Edges are never
+  removed, so the 32-bit index of an edge stays valid for the lifetime of
+  the arena. Heaps and path graph nodes only hold these indices.
+
+  The delta of an edge is computed on first use and cached in the edge.
+  The search has to invalidate it whenever the g-value of one of the end
+  points changes.
+*/
+class SapArena {
+	segmented_vector::SegmentedVector<StateActionPair> saps;
+	const StateRegistry* reg;
+	const SearchSpace* ssp;
+	int delta_epoch;
 
-struct Node {
-	int id = -1;
-	int g = -1;
-	shared_ptr<StateActionPair> sap = nullptr;
-	StateID heap_state = StateID::no_state;
-	bool is_inheap_node = false;
+	int compute_delta(const StateActionPair &edge) const;
+public:
+	SapArena(const StateRegistry* reg, const SearchSpace* ssp)
+		: reg(reg), ssp(ssp), delta_epoch(0) {
+	}
 
-	Node() {
-		id = -1;
-		g = -1;
-		sap = nullptr;
-		heap_state = StateID::no_state;
+	int add(StateID from, StateID to, int op_index, int generation) {
+		saps.push_back(StateActionPair(from, to, op_index, generation));
+		return saps.size() - 1;
 	}
 
-	Node (const Node &n) {
-		id = n.id;
-		g = n.g;
-		sap = n.sap;
-		heap_state = n.heap_state;
-		is_inheap_node = n.is_inheap_node;
+	const StateActionPair &operator[](int sap) const {
+		return saps[sap];
 	}
 
-	Node(int g, shared_ptr<StateActionPair> sap, StateID heap_state)
-	:id(-1), g(g), sap(sap), heap_state(heap_state){
-	};
+	size_t size() const {
+		return saps.size();
+	}
 
-	size_t hash() const{
-		size_t value_sap = sap->hash();
-		size_t value_heap =  this->heap_state.hash();
-		size_t seed = 0;
-		utils::hash_combine(seed, value_sap);
-		utils::hash_combine(seed, value_heap);
-		utils::hash_combine(seed, id);
-		return seed;
+	const StateRegistry *get_state_registry() const {
+		return reg;
 	}
 
-    bool operator==(const Node& other) const {
-		if (id != other.id)
-			return false;
-		if (g != other.g)
-			return false;
-		if ((!sap && other.sap) || (sap && !other.sap))
-            return false;
-
-        if (*sap != *other.sap)
-			return false;
-
-		if (heap_state != other.heap_state)
-			return false;
-		return true;
+	const GlobalOperator *get_op(int sap) const;
+	GlobalState get_from_state(int sap) const;
+	GlobalState get_to_state(int sap) const;
+	// Sidetrack cost g(from) + cost(op) - g(to) of the edge, -1 for the root
+	int get_delta(int sap) const {
+		const StateActionPair &edge = saps[sap];
+		if (edge.delta_epoch != delta_epoch) {
+			edge.delta = compute_delta(edge);
+			edge.delta_epoch = delta_epoch;
+		}
+		return edge.delta;
+	}
+
+	// Order by delta and break ties by the states of the edges
+	bool less(int lhs, int rhs) const {
+		int lhs_delta = get_delta(lhs);
+		int rhs_delta = get_delta(rhs);
+		if (lhs_delta != rhs_delta)
+			return lhs_delta < rhs_delta;
+		return saps[lhs].hash() < saps[rhs].hash();
+	}
+
+	void invalidate_delta(int sap) {
+		saps[sap].delta_epoch = -1;
+	}
+
+	void invalidate_all_deltas() {
+		++delta_epoch;
+	}
+
+	// Write all edges in bulk, and read them back into an empty arena.
+	// The epoch is kept, so the cached deltas stay valid.
+	void write(std::ostream &out) const;
+	bool read(std::istream &in);
+};
+
+struct Node {
+	// index of the node in the PathGraph, -1 if not added to it
+	int64_t id = -1;
+	int g = -1;
+	// index of the edge in the SapArena
+	int sap = -1;
+	StateID heap_state = StateID::no_state;
+	bool is_inheap_node = false;
+	// whether the node is reached from its parent via a cross edge
+	bool cross_edge = false;
+	// index of the node in the tree heap pool (-1 if not a tree heap node)
+	int heap_node = -1;
+	// cross edge chain the node was generated from (-1 if none) and the
+	// position of its parent in that chain
+	int chain = -1;
+	int chain_index = -1;
+
+	Node() = default;
+
+	Node(int g, int sap, StateID heap_state)
+	:id(-1), g(g), sap(sap), heap_state(heap_state){
 	};
 
-    bool operator<(const Node &other) const {
-		if (other.g < g)
-            return true;
-        if (other.g > g)
-			return false;
-		// Tie Breaking if they have equal g_values
-		size_t hash = this->hash();
-		size_t other_hash = other.hash();
-		if (other_hash  < hash)
-			return true;
-		return false;
+    bool operator==(const Node& other) const {
+		return id == other.id && g == other.g && sap == other.sap
+			&& heap_state == other.heap_state;
 	};
 };
 
@@ -179,17 +163,25 @@ namespace std {
 			return sap.hash();
 		}
 	};
-    template<>
-	struct hash<Node> {
-		std::size_t operator()(const Node &node) const {
-			return node.hash();
-		}
-	};
 }
 
-template <typename T> struct Cmp {
-    bool operator() (const T &lhs, const T &rhs) {
-		return *lhs < *rhs;
+// Orders edge indices by the delta of the edges
+struct SapCmp {
+	const SapArena &saps;
+	explicit SapCmp(const SapArena &saps) : saps(saps) {}
+    bool operator() (int lhs, int rhs) const {
+		return saps.less(lhs, rhs);
+	};
+};
+
+// Orders edges by generation first and by delta within a generation
+struct GenerationCmp {
+	const SapArena &saps;
+	explicit GenerationCmp(const SapArena &saps) : saps(saps) {}
+    bool operator() (int lhs, int rhs) const {
+		if (saps[lhs].generation != saps[rhs].generation)
+			return saps[lhs].generation < saps[rhs].generation;
+		return saps.less(lhs, rhs);
 	};
 };
 #endif
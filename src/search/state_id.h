@@ -24,8 +24,9 @@ private:
     // No implementation to prevent default construction
     StateID();
 public:
-    ~StateID() {
-    }
+    // Trivial, so that ids can be copied as raw bytes (see
+    // SegmentedVector::write)
+    ~StateID() = default;
 
     static const StateID no_state;
 
@@ -3,6 +3,8 @@
 #include "global_operator.h"
 #include "per_state_information.h"
 
+#include <cstdint>
+
 using namespace std;
 
 StateRegistry::StateRegistry(
@@ -94,6 +96,36 @@ int StateRegistry::get_state_size_in_bytes() const {
     return get_bins_per_state() * sizeof(PackedStateBin);
 }
 
+void StateRegistry::write_states(ostream &out) const {
+    int64_t num_states = size();
+    int32_t bins_per_state = get_bins_per_state();
+    out.write(reinterpret_cast<const char *>(&num_states), sizeof(num_states));
+    out.write(reinterpret_cast<const char *>(&bins_per_state), sizeof(bins_per_state));
+    state_data_pool.write(out);
+}
+
+bool StateRegistry::read_states(istream &in) {
+    int64_t num_states;
+    int32_t bins_per_state;
+    if (!in.read(reinterpret_cast<char *>(&num_states), sizeof(num_states)) ||
+        !in.read(reinterpret_cast<char *>(&bins_per_state), sizeof(bins_per_state)) ||
+        bins_per_state != get_bins_per_state() || num_states < 1 || size() != 1)
+        return false;
+    vector<PackedStateBin> initial_state(bins_per_state);
+    if (!in.read(reinterpret_cast<char *>(initial_state.data()),
+                 bins_per_state * sizeof(PackedStateBin)) ||
+        !equal(initial_state.begin(), initial_state.end(), state_data_pool[0]))
+        return false;
+    if (!state_data_pool.read(in, num_states - 1))
+        return false;
+    registered_states.reserve(num_states);
+    for (int64_t id = 1; id < num_states; ++id) {
+        if (!registered_states.insert(StateID(id)).second)
+            return false;
+    }
+    return true;
+}
+
 void StateRegistry::subscribe(PerStateInformationBase *psi) const {
     subscribers.insert(psi);
 }
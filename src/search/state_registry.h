@@ -212,6 +212,16 @@ public:
 
     int get_state_size_in_bytes() const;
 
+    /*
+      Write the packed data of all registered states to out in bulk.
+      read_states registers the states written this way in a registry of
+      the same task that contains only the initial state, which has to be
+      the first state of the data. The states get the ids they had in the
+      registry that wrote them.
+    */
+    void write_states(std::ostream &out) const;
+    bool read_states(std::istream &in);
+
     /*
       Remembers the given PerStateInformation. If this StateRegistry is
       destroyed, it notifies all subscribed PerStateInformation objects.
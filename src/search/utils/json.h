@@ -0,0 +1,52 @@
+#ifndef UTILS_JSON_H
+#define UTILS_JSON_H
+
+#include <cstdio>
+#include <ostream>
+#include <string>
+
+namespace utils {
+/*
+  Write s to os as a JSON string literal. Operator and fact names are
+  taken verbatim from the task, so quotes, backslashes and control
+  characters are escaped. Header only, since the standalone K* tools
+  write JSON as well without linking the planner.
+*/
+inline void write_json_string(std::ostream &os, const std::string &s) {
+    os << '"';
+    // Write the characters between two escaped ones at once
+    size_t start = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = s[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+        os.write(s.data() + start, i - start);
+        start = i + 1;
+        switch (c) {
+        case '"':
+            os << "\\\"";
+            break;
+        case '\\':
+            os << "\\\\";
+            break;
+        case '\n':
+            os << "\\n";
+            break;
+        case '\r':
+            os << "\\r";
+            break;
+        case '\t':
+            os << "\\t";
+            break;
+        default:
+            char buffer[7];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            os << buffer;
+        }
+    }
+    os.write(s.data() + start, s.size() - start);
+    os << '"';
+}
+}
+
+#endif
@@ -18,7 +18,9 @@
 
 #include "language.h"
 
+#include <cstdint>
 #include <iostream>
+#include <string>
 
 #define ABORT(msg) \
     ( \
@@ -50,6 +52,8 @@ bool is_exit_code_error_reentrant(ExitCode exitcode);
 void register_event_handlers();
 void report_exit_code_reentrant(ExitCode exitcode);
 int get_process_id();
+// Cut the file down to its first size bytes
+bool truncate_file(const std::string &filename, int64_t size);
 }
 
 #endif
@@ -263,6 +263,10 @@ void report_exit_code_reentrant(ExitCode exitcode) {
 int get_process_id() {
     return getpid();
 }
+
+bool truncate_file(const string &filename, int64_t size) {
+    return truncate(filename.c_str(), size) == 0;
+}
 }
 
 #endif
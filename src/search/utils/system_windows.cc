@@ -7,8 +7,11 @@
 
 #include <csignal>
 #include <ctime>
+#include <fcntl.h>
+#include <io.h>
 #include <iostream>
 #include <process.h>
+#include <share.h>
 #include <psapi.h>
 
 using namespace std;
@@ -74,6 +77,15 @@ void report_exit_code_reentrant(ExitCode exitcode) {
 int get_process_id() {
     return _getpid();
 }
+
+bool truncate_file(const string &filename, int64_t size) {
+    int file;
+    if (_sopen_s(&file, filename.c_str(), _O_RDWR | _O_BINARY, _SH_DENYNO, 0) != 0)
+        return false;
+    bool truncated = _chsize_s(file, size) == 0;
+    _close(file);
+    return truncated;
+}
 }
 
 #endif